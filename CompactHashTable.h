@@ -0,0 +1,475 @@
+/**
+ * CompactHashTable.h
+ * Defines the CompactHashTable class template, an alternative layout with the same
+ * core interface as BasicHashTable.
+ *
+ * Entries (hash, key, value) are appended to a dense array in insertion order. The
+ * open-addressing table holds only an index into that array per slot, stored in 1, 2,
+ * 4 or 8 bytes depending on the capacity, so an empty slot costs a few bytes instead
+ * of a whole bucket. Removing an entry leaves a hole in the entry array and a DUMMY
+ * index so probe chains stay intact; both are dropped the next time the table is
+ * rebuilt. Iteration is a linear scan of the entry array.
+ */
+
+#ifndef COMPACTHASHTABLE_H
+#define COMPACTHASHTABLE_H
+
+#include "HashTable.h"
+
+#include <bit>
+#include <stdexcept>
+
+// Key storage policy for CompactHashTable: how an entry holds its key. This one stores
+// the key itself.
+template <typename Key>
+struct PlainKeyStore {
+    using Stored = Key;
+    using View = const Key&;
+
+    template <typename K> Stored store(K&& key) { return Key(std::forward<K>(key)); }
+    View view(const Stored& key) const { return key; }
+    // Frees what a removed key holds.
+    void release(Stored& key) { key = Key(); }
+    // Called by rebuilds with the live entries; nothing to reclaim here.
+    template <typename Range, typename Proj> void compact(Range&, Proj) {}
+};
+
+// Key storage for strings. Keys of up to INLINE_LIMIT bytes live in the handle; longer
+// keys are appended to one arena owned by the table and referenced by offset, so
+// inserting never allocates per key and rebuilding moves only 16-byte handles. Removed
+// arena keys become garbage that compact() drops once it is half the arena. Lookups see
+// keys as string_view, so Hash and KeyEqual must accept string_view.
+class ArenaKeyStore {
+public:
+    static constexpr size_t INLINE_LIMIT = 12;
+
+    struct Stored {
+        uint32_t length = 0;
+        char bytes[INLINE_LIMIT]; // The key if length <= INLINE_LIMIT, else its uint64_t arena offset.
+    };
+    using View = string_view;
+
+    Stored store(string_view key) {
+        if (key.size() > UINT32_MAX) {
+            throw length_error("ArenaKeyStore: key too long");
+        }
+        Stored handle;
+        handle.length = static_cast<uint32_t>(key.size());
+        if (key.size() <= INLINE_LIMIT) {
+            memcpy(handle.bytes, key.data(), key.size());
+        } else {
+            uint64_t offset = arena.size();
+            arena.insert(arena.end(), key.begin(), key.end());
+            memcpy(handle.bytes, &offset, sizeof(offset));
+        }
+        return handle;
+    }
+
+    View view(const Stored& handle) const {
+        if (handle.length <= INLINE_LIMIT) {
+            return string_view(handle.bytes, handle.length);
+        }
+        return string_view(arena.data() + offsetOf(handle), handle.length);
+    }
+
+    void release(Stored& handle) {
+        if (handle.length > INLINE_LIMIT) {
+            garbage += handle.length;
+        }
+        handle.length = 0;
+    }
+
+    // Copies the live keys into a fresh arena when garbage is at least half of it.
+    template <typename Range, typename Proj>
+    void compact(Range& entries, Proj proj) {
+        if (garbage == 0 || garbage * 2 < arena.size()) {
+            return;
+        }
+        vector<char> live;
+        live.reserve(arena.size() - garbage);
+        for (auto& entry : entries) {
+            Stored& handle = invoke(proj, entry);
+            if (handle.length > INLINE_LIMIT) {
+                uint64_t offset = live.size();
+                live.insert(live.end(), arena.begin() + offsetOf(handle),
+                            arena.begin() + offsetOf(handle) + handle.length);
+                memcpy(handle.bytes, &offset, sizeof(offset));
+            }
+        }
+        arena = std::move(live);
+        garbage = 0;
+    }
+
+private:
+    vector<char> arena;  // Out-of-line key bytes, back to back.
+    size_t garbage = 0;  // Arena bytes of removed keys.
+
+    static uint64_t offsetOf(const Stored& handle) {
+        uint64_t offset;
+        memcpy(&offset, handle.bytes, sizeof(offset));
+        return offset;
+    }
+};
+
+// Strings go to the arena; every other key type is stored as is.
+template <typename Key>
+using DefaultKeyStore = conditional_t<is_same_v<Key, string>, ArenaKeyStore, PlainKeyStore<Key>>;
+
+template <typename Key,
+          typename Value,
+          typename Hash = DefaultHash<Key>,
+          typename KeyEqual = DefaultKeyEqual<Key>,
+          typename KeyStore = DefaultKeyStore<Key>>
+class CompactHashTable {
+public:
+
+    // Default capacity (index slots) for initialization.
+    static constexpr size_t DEFAULT_INITIAL_CAPACITY = 8;
+
+    // Constructor; capacity is rounded up to a power of two of at least 8.
+    CompactHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY,
+                     const Hash& hasher = Hash(), const KeyEqual& keyEqual = KeyEqual());
+
+    // Core Mutators and Accessors
+    bool insert(const Key& key, Value value) { return emplace(key, std::move(value)); }
+    bool insert(Key&& key, Value value) { return emplace(std::move(key), std::move(value)); }
+    // Inserts key with a value built from valueArgs; the Key is only built if the key is new.
+    template <typename K, typename... Args>
+    bool emplace(K&& key, Args&&... valueArgs);
+    bool remove(const Key& key) { return removeKey(key); }
+    bool contains(const Key& key) const { return findEntry(key, hasher(key)).has_value(); }
+    // Retrieves value. Returns optional<Value> to handle key absence.
+    optional<Value> get(const Key& key) const { return getValue(key); }
+    // Subscript operator. Returns reference to value, inserting a value-initialized entry if key is absent.
+    Value& operator[](const Key& key) { return subscript(key); }
+
+    // Heterogeneous lookups, enabled when Hash and KeyEqual are transparent.
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    bool remove(const K& key) { return removeKey(key); }
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    bool contains(const K& key) const { return findEntry(key, hasher(key)).has_value(); }
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    optional<Value> get(const K& key) const { return getValue(key); }
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    Value& operator[](const K& key) { return subscript(key); }
+
+    // Returns a vector containing all keys in insertion order.
+    vector<Key> keys() const;
+    // Calls visit(key, value) for every entry in insertion order. The key is passed as
+    // KeyStore::View (string_view for string keys).
+    template <typename Visitor> void forEach(Visitor visit);
+    template <typename Visitor> void forEach(Visitor visit) const;
+
+    // Status Metrics
+    double alpha() const;     // Calculates and returns the load factor (size/capacity).
+    size_t capacity() const;  // Returns the number of index slots.
+    size_t size() const;      // Returns the number of stored elements.
+    size_t indexWidth() const; // Returns the bytes used per index slot (1, 2, 4 or 8).
+
+    // Stream output operator for displaying the entries in insertion order.
+    friend ostream& operator<<(ostream& os, const CompactHashTable& hashTable) {
+        for (size_t i = 0; i < hashTable.entries.size(); ++i) {
+            const Entry& entry = hashTable.entries[i];
+            if (entry.live) {
+                os << "Entry " << i << ": <" << hashTable.keyStore.view(entry.key) << ", " << entry.value << ">" << endl;
+            }
+        }
+        return os;
+    }
+
+private:
+    // Index slot values other than entry positions.
+    static constexpr int64_t SLOT_EMPTY = -1;  // Never used since the last rebuild; ends probes.
+    static constexpr int64_t SLOT_DUMMY = -2;  // Entry removed; probes continue past it.
+
+    struct Entry {
+        size_t hash;
+        typename KeyStore::Stored key;
+        Value value;
+        bool live;  // False once removed; the entry stays as a hole until the next rebuild.
+    };
+
+    [[no_unique_address]] Hash hasher;       // Hash policy.
+    [[no_unique_address]] KeyEqual keyEqual; // Key equality policy.
+    [[no_unique_address]] KeyStore keyStore; // Owns key storage outside the entries, if any.
+
+    vector<Entry> entries;          // Dense entries in insertion order, including holes.
+    vector<unsigned char> indices;  // capacity slots of width bytes each.
+    size_t width = 1;               // Bytes per index slot.
+    size_t currentSize = 0;         // Live entries.
+    size_t currentCapacity = 0;     // Number of index slots (power of two).
+
+    // Index slot accessors. Values are signed so EMPTY and DUMMY fit at every width.
+    int64_t slotAt(size_t slot) const;
+    void setSlot(size_t slot, int64_t value);
+
+    // Probe order over the index slots (CPython's recurrence): every slot is reached, and
+    // the high bits of the hash are folded in through perturb early in the sequence.
+    struct Probe {
+        size_t slot;
+        size_t perturb;
+        size_t mask;
+        Probe(size_t hash, size_t mask): slot(hash & mask), perturb(hash), mask(mask) {}
+        void next() {
+            perturb >>= 5;
+            slot = (slot * 5 + perturb + 1) & mask;
+        }
+    };
+
+    // Returns the index slot pointing at key's entry, or nullopt.
+    template <typename K> optional<size_t> findEntry(const K& key, size_t hash) const;
+    // Returns key's index slot and true, or the slot a new entry should use and false.
+    template <typename K> pair<size_t, bool> findOrReserve(const K& key, size_t hash);
+    // Appends an entry for a key known to be absent and points slot at it.
+    template <typename K, typename... Args> Entry& append(size_t slot, size_t hash, K&& key, Args&&... valueArgs);
+    template <typename K> bool removeKey(const K& key);
+    template <typename K> optional<Value> getValue(const K& key) const;
+    template <typename K> Value& subscript(const K& key);
+
+    // Entries that fit before a rebuild: two thirds of the slots, as in CPython.
+    static size_t usable(size_t capacity) { return capacity * 2 / 3; }
+    // Rebuilds at newCapacity, dropping holes and DUMMY slots.
+    void rebuild(size_t newCapacity);
+
+};
+
+#define COMPACT_TEMPLATE template <typename Key, typename Value, typename Hash, typename KeyEqual, typename KeyStore>
+#define COMPACT_TYPE CompactHashTable<Key, Value, Hash, KeyEqual, KeyStore>
+
+// Constructor. Allocates the index table; entries are reserved up to the usable count.
+COMPACT_TEMPLATE
+COMPACT_TYPE::CompactHashTable(size_t initCapacity, const Hash& hasher, const KeyEqual& keyEqual):
+    hasher(hasher), keyEqual(keyEqual) {
+    rebuild(bit_ceil(max<size_t>(initCapacity, DEFAULT_INITIAL_CAPACITY)));
+}
+
+// Inserts a key-value pair. Returns true on success, false on duplicate key.
+COMPACT_TEMPLATE
+template <typename K, typename... Args>
+bool COMPACT_TYPE::emplace(K&& key, Args&&... valueArgs) {
+    size_t hash_val = hasher(key);
+    auto [slot, found] = findOrReserve(key, hash_val);
+    if (found) {
+        return false; // Duplicate found, insertion failed.
+    }
+    append(slot, hash_val, std::forward<K>(key), std::forward<Args>(valueArgs)...);
+    return true;
+}
+
+// Removes a key. The entry becomes a hole and its slot DUMMY.
+COMPACT_TEMPLATE
+template <typename K>
+bool COMPACT_TYPE::removeKey(const K& key) {
+    optional<size_t> slot = findEntry(key, hasher(key));
+    if (!slot) {
+        return false;
+    }
+    Entry& entry = entries[slotAt(*slot)];
+    entry.live = false;
+    keyStore.release(entry.key); // Release the key's and value's storage now, not at the next rebuild.
+    entry.value = Value();
+    setSlot(*slot, SLOT_DUMMY);
+    currentSize--;
+    return true;
+}
+
+// Retrieves the value associated with a key. Returns nullopt if the key is absent.
+COMPACT_TEMPLATE
+template <typename K>
+optional<Value> COMPACT_TYPE::getValue(const K& key) const {
+    if (optional<size_t> slot = findEntry(key, hasher(key))) {
+        return entries[slotAt(*slot)].value;
+    }
+    return nullopt;
+}
+
+// Returns a reference to key's value, inserting a value-initialized entry if key is absent.
+COMPACT_TEMPLATE
+template <typename K>
+Value& COMPACT_TYPE::subscript(const K& key) {
+    size_t hash_val = hasher(key);
+    auto [slot, found] = findOrReserve(key, hash_val);
+    if (found) {
+        return entries[slotAt(slot)].value;
+    }
+    return append(slot, hash_val, key).value;
+}
+
+// Returns all keys in insertion order.
+COMPACT_TEMPLATE
+vector<Key> COMPACT_TYPE::keys() const {
+    vector<Key> allKeys;
+    allKeys.reserve(currentSize);
+    for (const Entry& entry : entries) {
+        if (entry.live) {
+            allKeys.push_back(Key(keyStore.view(entry.key)));
+        }
+    }
+    return allKeys;
+}
+
+// Scans the entry array; no index slots are touched.
+COMPACT_TEMPLATE
+template <typename Visitor>
+void COMPACT_TYPE::forEach(Visitor visit) {
+    for (Entry& entry : entries) {
+        if (entry.live) {
+            visit(keyStore.view(entry.key), entry.value);
+        }
+    }
+}
+
+COMPACT_TEMPLATE
+template <typename Visitor>
+void COMPACT_TYPE::forEach(Visitor visit) const {
+    for (const Entry& entry : entries) {
+        if (entry.live) {
+            visit(keyStore.view(entry.key), entry.value);
+        }
+    }
+}
+
+// Calculates and returns the current load factor (alpha = size / capacity).
+COMPACT_TEMPLATE
+double COMPACT_TYPE::alpha() const {
+    return static_cast<double>(currentSize) / static_cast<double>(currentCapacity);
+}
+
+// Returns the number of index slots (capacity).
+COMPACT_TEMPLATE
+size_t COMPACT_TYPE::capacity() const {
+    return currentCapacity;
+}
+
+// Returns the number of elements currently stored in the table (size).
+COMPACT_TEMPLATE
+size_t COMPACT_TYPE::size() const {
+    return currentSize;
+}
+
+// Returns the width of an index slot in bytes.
+COMPACT_TEMPLATE
+size_t COMPACT_TYPE::indexWidth() const {
+    return width;
+}
+
+// Reads an index slot at the current width.
+COMPACT_TEMPLATE
+int64_t COMPACT_TYPE::slotAt(size_t slot) const {
+    const unsigned char* pos = indices.data() + slot * width;
+    switch (width) {
+        case 1: { int8_t v; memcpy(&v, pos, 1); return v; }
+        case 2: { int16_t v; memcpy(&v, pos, 2); return v; }
+        case 4: { int32_t v; memcpy(&v, pos, 4); return v; }
+        default: { int64_t v; memcpy(&v, pos, 8); return v; }
+    }
+}
+
+// Writes an index slot at the current width.
+COMPACT_TEMPLATE
+void COMPACT_TYPE::setSlot(size_t slot, int64_t value) {
+    unsigned char* pos = indices.data() + slot * width;
+    switch (width) {
+        case 1: { int8_t v = static_cast<int8_t>(value); memcpy(pos, &v, 1); break; }
+        case 2: { int16_t v = static_cast<int16_t>(value); memcpy(pos, &v, 2); break; }
+        case 4: { int32_t v = static_cast<int32_t>(value); memcpy(pos, &v, 4); break; }
+        default: memcpy(pos, &value, 8); break;
+    }
+}
+
+// Probes index slots until the key's entry or an EMPTY slot. Entries are only compared
+// when their cached hash matches.
+COMPACT_TEMPLATE
+template <typename K>
+optional<size_t> COMPACT_TYPE::findEntry(const K& key, size_t hash) const {
+    for (Probe seq(hash, currentCapacity - 1); ; seq.next()) {
+        int64_t ix = slotAt(seq.slot);
+        if (ix == SLOT_EMPTY) {
+            return nullopt;
+        }
+        if (ix != SLOT_DUMMY) {
+            const Entry& entry = entries[ix];
+            if (entry.hash == hash && keyEqual(keyStore.view(entry.key), key)) {
+                return seq.slot;
+            }
+        }
+    }
+}
+
+// Like findEntry(), but also remembers the first DUMMY or EMPTY slot for a new entry.
+// Rebuilds first when the entry array is full, so the returned slot is always usable.
+COMPACT_TEMPLATE
+template <typename K>
+pair<size_t, bool> COMPACT_TYPE::findOrReserve(const K& key, size_t hash) {
+    optional<size_t> reuse;
+    for (Probe seq(hash, currentCapacity - 1); ; seq.next()) {
+        int64_t ix = slotAt(seq.slot);
+        if (ix == SLOT_EMPTY) {
+            if (entries.size() < usable(currentCapacity)) {
+                return {reuse.value_or(seq.slot), false};
+            }
+            break;
+        }
+        if (ix == SLOT_DUMMY) {
+            reuse = reuse.value_or(seq.slot);
+        } else if (entries[ix].hash == hash && keyEqual(keyStore.view(entries[ix].key), key)) {
+            return {seq.slot, true};
+        }
+    }
+
+    // The entry array is full. Grow if most entries are live; otherwise the rebuild at
+    // the same capacity just squeezes out the holes.
+    rebuild(currentSize + 1 > usable(currentCapacity) / 2 ? currentCapacity * 2 : currentCapacity);
+    Probe seq(hash, currentCapacity - 1);
+    while (slotAt(seq.slot) != SLOT_EMPTY) {
+        seq.next();
+    }
+    return {seq.slot, false};
+}
+
+// Appends the entry and points the slot at it.
+COMPACT_TEMPLATE
+template <typename K, typename... Args>
+auto COMPACT_TYPE::append(size_t slot, size_t hash, K&& key, Args&&... valueArgs) -> Entry& {
+    setSlot(slot, static_cast<int64_t>(entries.size()));
+    entries.push_back(Entry{hash, keyStore.store(std::forward<K>(key)), Value(std::forward<Args>(valueArgs)...), true});
+    currentSize++;
+    return entries.back();
+}
+
+// Compacts the live entries to the front of a new entry array and re-indexes them by
+// their cached hashes. Only the stored key handles move; the key store may compact its
+// own storage afterwards. The index width is the smallest that holds every entry position.
+COMPACT_TEMPLATE
+void COMPACT_TYPE::rebuild(size_t newCapacity) {
+    size_t newWidth = newCapacity <= 0x80 ? 1 : newCapacity <= 0x8000 ? 2 : newCapacity <= 0x80000000ULL ? 4 : 8;
+
+    // Allocate before touching the table.
+    vector<unsigned char> newIndices(newCapacity * newWidth, 0xFF); // All bytes 0xFF reads as -1 (EMPTY).
+    vector<Entry> newEntries;
+    newEntries.reserve(usable(newCapacity));
+
+    for (Entry& entry : entries) {
+        if (entry.live) {
+            newEntries.push_back(std::move(entry));
+        }
+    }
+    indices = std::move(newIndices);
+    entries = std::move(newEntries);
+    keyStore.compact(entries, &Entry::key);
+    width = newWidth;
+    currentCapacity = newCapacity;
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        Probe seq(entries[i].hash, currentCapacity - 1);
+        while (slotAt(seq.slot) != SLOT_EMPTY) {
+            seq.next();
+        }
+        setSlot(seq.slot, static_cast<int64_t>(i));
+    }
+}
+
+#undef COMPACT_TEMPLATE
+#undef COMPACT_TYPE
+
+#endif
@@ -0,0 +1,447 @@
+/**
+ * ConcurrentHashTable.h
+ * Defines the ConcurrentHashTable class template, a thread-safe open addressing
+ * hash table for many reader and writer threads sharing one table.
+ *
+ * Slots hold atomic pointers to immutable key nodes, so readers never lock: they
+ * follow the probe sequence with acquire loads inside an epoch guard. Writers
+ * serialize per key on one of LOCK_STRIPES mutexes and claim slots with CAS, so
+ * writers on different keys proceed in parallel. A resize holds the writer gate
+ * exclusively, builds the new slot array off to the side and publishes it with a
+ * single pointer swap. Retired nodes and arrays are freed only once no reader can
+ * still be looking at them.
+ */
+
+#ifndef CONCURRENTHASHTABLE_H
+#define CONCURRENTHASHTABLE_H
+
+#include "HashTable.h"
+
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+// Epoch-based reclamation for memory that lock-free readers may still hold.
+// Readers announce themselves in one of two counters chosen by the epoch's parity;
+// synchronize() flips the epoch and waits for the old parity to drain.
+class EpochReclaimer {
+    // Active reader counts for each epoch parity, one cache line per slot.
+    struct alignas(64) Counter {
+        atomic<int64_t> active[2] = {0, 0};
+    };
+
+public:
+
+    // Number of cache-line padded reader counter slots; threads hash onto them.
+    static constexpr size_t READER_SLOTS = 64;
+    // Retired objects collected before a synchronize() frees them in one batch.
+    static constexpr size_t RETIRE_BATCH = 128;
+
+    EpochReclaimer() = default;
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+    // Frees everything still retired. No reader may be active.
+    ~EpochReclaimer() {
+        for (auto& [object, deleter] : retired) {
+            deleter(object);
+        }
+    }
+
+    // Marks the calling thread as reading for its lifetime. Entering is lock-free:
+    // it only retries if the epoch flips between announcing and re-checking.
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const EpochReclaimer& reclaimer):
+            counter(reclaimer.slotForThread()) {
+            for (;;) {
+                uint64_t epoch = reclaimer.epoch.load();
+                parity = epoch & 1;
+                counter.active[parity].fetch_add(1);
+                if (reclaimer.epoch.load() == epoch) {
+                    break;
+                }
+                counter.active[parity].fetch_sub(1);
+            }
+        }
+        ~ReadGuard() { counter.active[parity].fetch_sub(1, memory_order_release); }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        Counter& counter;
+        size_t parity = 0;
+    };
+
+    // Hands an unlinked object over for deletion once current readers are done with it.
+    void retire(void* object, void (*deleter)(void*)) {
+        vector<pair<void*, void (*)(void*)>> batch;
+        {
+            lock_guard<mutex> lock(retireMutex);
+            retired.emplace_back(object, deleter);
+            if (retired.size() < RETIRE_BATCH) {
+                return;
+            }
+            batch.swap(retired);
+        }
+        synchronize();
+        for (auto& [retiredObject, retiredDeleter] : batch) {
+            retiredDeleter(retiredObject);
+        }
+    }
+
+    // Returns once every reader that might have seen memory unlinked before the call has left.
+    void synchronize() {
+        lock_guard<mutex> lock(syncMutex);
+        uint64_t oldParity = epoch.fetch_add(1) & 1;
+        for (const Counter& counter : counters) {
+            // seq_cst like the reader's announce and re-check: with a weaker load the
+            // model lets this miss a reader that also missed the new epoch.
+            while (counter.active[oldParity].load() != 0) {
+                this_thread::yield();
+            }
+        }
+    }
+
+private:
+    // Picks the counter slot for the calling thread, fixed for the thread's lifetime.
+    Counter& slotForThread() const {
+        static thread_local size_t slot = hash<thread::id>()(this_thread::get_id()) % READER_SLOTS;
+        return counters[slot];
+    }
+
+    atomic<uint64_t> epoch{0};
+    mutable Counter counters[READER_SLOTS];
+    mutex syncMutex;                                  // Serializes epoch flips.
+    mutex retireMutex;                                // Guards retired.
+    vector<pair<void*, void (*)(void*)>> retired;     // Awaiting the next synchronize().
+};
+
+template <typename Key,
+          typename Value,
+          typename Hash = DefaultHash<Key>,
+          typename KeyEqual = DefaultKeyEqual<Key>>
+class ConcurrentHashTable {
+    static_assert(is_trivially_copyable_v<Value>, "values are stored in std::atomic and must be trivially copyable");
+
+public:
+
+    // Default capacity for initialization.
+    static constexpr size_t DEFAULT_INITIAL_CAPACITY = 16;
+    // Number of writer mutexes. Keys hash onto stripes, so the same key always uses the same one.
+    static constexpr size_t LOCK_STRIPES = 64;
+
+    // Constructor; capacity is rounded up to a power of two.
+    ConcurrentHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY,
+                        const Hash& hasher = Hash(), const KeyEqual& keyEqual = KeyEqual());
+    ~ConcurrentHashTable();
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+
+    // Writers. Safe to call from any number of threads.
+    bool insert(Key key, Value value);
+    bool remove(const Key& key);
+    // Replaces the value of an existing key. Returns false if the key is absent.
+    bool assign(const Key& key, Value value);
+
+    // Lock-free readers.
+    bool contains(const Key& key) const;
+    optional<Value> get(const Key& key) const;
+    // Read-only subscript; returns a value-initialized Value when the key is absent.
+    Value operator[](const Key& key) const;
+    // Snapshot of the keys present while the call runs.
+    vector<Key> keys() const;
+
+    // Status Metrics
+    double alpha() const;     // Calculates and returns the load factor (size/capacity).
+    size_t capacity() const;  // Returns the total slot count.
+    size_t size() const;      // Returns the number of stored elements.
+
+private:
+    // Immutable apart from its value, so readers may compare keys without locks.
+    struct Node {
+        size_t hash;
+        Key key;
+        atomic<Value> value;
+        Node(size_t hash, Key key, Value value): hash(hash), key(std::move(key)), value(value) {}
+    };
+
+    // One generation of the slot array. Replaced wholesale by resize.
+    struct Table {
+        size_t capacity;
+        unique_ptr<atomic<Node*>[]> slots;
+        atomic<size_t> used{0}; // Slots that are not null (nodes and tombstones).
+        explicit Table(size_t capacity): capacity(capacity), slots(new atomic<Node*>[capacity]) {
+            for (size_t i = 0; i < capacity; i++) {
+                slots[i].store(nullptr, memory_order_relaxed);
+            }
+        }
+    };
+
+    struct alignas(64) Stripe {
+        mutex lock;
+    };
+
+    // Marks a removed slot. Never dereferenced.
+    static Node* tombstone() { return reinterpret_cast<Node*>(uintptr_t(1)); }
+    // Slots may fill to half before a resize, counting tombstones.
+    static size_t maxUsed(size_t capacity) { return capacity / 2; }
+    // Index of the i-th probe; triangular steps visit every slot of a power-of-two table.
+    static size_t probeIndex(size_t hash, size_t step, size_t capacity) {
+        return (hash + step * (step + 1) / 2) & (capacity - 1);
+    }
+
+    // Returns the node holding key in table, or nullptr. Caller must hold a ReadGuard.
+    Node* findNode(const Table& table, const Key& key, size_t hash) const;
+    // Rebuilds the slot array if it is still at least as full as when the caller saw it.
+    void grow(const Table* seen);
+
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] KeyEqual keyEqual;
+
+    atomic<Table*> table;              // Current slot array.
+    atomic<size_t> currentSize{0};     // Current element count.
+    mutable shared_mutex writerGate;   // Shared by writers, exclusive during resize.
+    Stripe stripes[LOCK_STRIPES];      // Per-key writer locks.
+    mutable EpochReclaimer reclaimer;  // Defers frees until readers are done.
+};
+
+#define CONCURRENT_TEMPLATE template <typename Key, typename Value, typename Hash, typename KeyEqual>
+#define CONCURRENT_TYPE ConcurrentHashTable<Key, Value, Hash, KeyEqual>
+
+// Constructor. Allocates the first slot array.
+CONCURRENT_TEMPLATE
+CONCURRENT_TYPE::ConcurrentHashTable(size_t initCapacity, const Hash& hasher, const KeyEqual& keyEqual):
+    hasher(hasher), keyEqual(keyEqual),
+    table(new Table(bit_ceil(max<size_t>(initCapacity, 2)))) {}
+
+// Destructor. No other thread may be using the table.
+CONCURRENT_TEMPLATE
+CONCURRENT_TYPE::~ConcurrentHashTable() {
+    Table* current = table.load();
+    for (size_t i = 0; i < current->capacity; i++) {
+        Node* node = current->slots[i].load(memory_order_relaxed);
+        if (node != nullptr && node != tombstone()) {
+            delete node;
+        }
+    }
+    delete current;
+}
+
+// Inserts a key-value pair. Returns false if the key is already present.
+CONCURRENT_TEMPLATE
+bool CONCURRENT_TYPE::insert(Key key, Value value) {
+    size_t hash_val = hasher(key);
+    Node* node = nullptr;
+
+    for (;;) {
+        Table* seen;
+        {
+            shared_lock<shared_mutex> gate(writerGate);
+            lock_guard<mutex> stripe(stripes[hash_val % LOCK_STRIPES].lock);
+            EpochReclaimer::ReadGuard guard(reclaimer); // Other keys' nodes may be retired meanwhile.
+            Table& current = *table.load(memory_order_acquire);
+            seen = &current;
+
+            // Same-key writers are serialized by the stripe, so a miss here stays a miss.
+            // After a retry the key has already been moved into node.
+            if (findNode(current, node != nullptr ? node->key : key, hash_val) != nullptr) {
+                delete node;
+                return false;
+            }
+            if (node == nullptr) {
+                node = new Node(hash_val, std::move(key), value);
+            }
+
+            // Claim the first free slot; a failed CAS means another key took it first.
+            for (size_t step = 0; step < current.capacity; step++) {
+                atomic<Node*>& slot = current.slots[probeIndex(hash_val, step, current.capacity)];
+                Node* expected = slot.load(memory_order_acquire);
+                if (expected == tombstone()) {
+                    if (slot.compare_exchange_strong(expected, node, memory_order_acq_rel)) {
+                        currentSize.fetch_add(1, memory_order_relaxed);
+                        return true;
+                    }
+                } else if (expected == nullptr) {
+                    // Reserve room first so concurrent inserts cannot overfill the array.
+                    if (current.used.fetch_add(1, memory_order_relaxed) >= maxUsed(current.capacity)) {
+                        current.used.fetch_sub(1, memory_order_relaxed);
+                        break;
+                    }
+                    if (slot.compare_exchange_strong(expected, node, memory_order_acq_rel)) {
+                        currentSize.fetch_add(1, memory_order_relaxed);
+                        return true;
+                    }
+                    current.used.fetch_sub(1, memory_order_relaxed);
+                }
+            }
+        }
+        // Out of room: resize without holding any writer locks, then retry.
+        grow(seen);
+    }
+}
+
+// Removes a key. The slot becomes a tombstone and the node is freed once readers move on.
+CONCURRENT_TEMPLATE
+bool CONCURRENT_TYPE::remove(const Key& key) {
+    size_t hash_val = hasher(key);
+    Node* removed = nullptr;
+    {
+        shared_lock<shared_mutex> gate(writerGate);
+        lock_guard<mutex> stripe(stripes[hash_val % LOCK_STRIPES].lock);
+        EpochReclaimer::ReadGuard guard(reclaimer);
+        Table& current = *table.load(memory_order_acquire);
+
+        for (size_t step = 0; step < current.capacity; step++) {
+            atomic<Node*>& slot = current.slots[probeIndex(hash_val, step, current.capacity)];
+            Node* node = slot.load(memory_order_acquire);
+            if (node == nullptr) {
+                break;
+            }
+            if (node != tombstone() && node->hash == hash_val && keyEqual(node->key, key)) {
+                // Only this key's stripe ever replaces a live node, so a plain store is enough.
+                slot.store(tombstone(), memory_order_release);
+                currentSize.fetch_sub(1, memory_order_relaxed);
+                removed = node;
+                break;
+            }
+        }
+    }
+    if (removed == nullptr) {
+        return false;
+    }
+    reclaimer.retire(removed, [](void* p) { delete static_cast<Node*>(p); });
+    return true;
+}
+
+// Stores a new value for an existing key.
+CONCURRENT_TEMPLATE
+bool CONCURRENT_TYPE::assign(const Key& key, Value value) {
+    size_t hash_val = hasher(key);
+    shared_lock<shared_mutex> gate(writerGate);
+    lock_guard<mutex> stripe(stripes[hash_val % LOCK_STRIPES].lock);
+    EpochReclaimer::ReadGuard guard(reclaimer);
+
+    Node* node = findNode(*table.load(memory_order_acquire), key, hash_val);
+    if (node == nullptr) {
+        return false;
+    }
+    node->value.store(value, memory_order_release);
+    return true;
+}
+
+// Checks if a key exists in the hash table.
+CONCURRENT_TEMPLATE
+bool CONCURRENT_TYPE::contains(const Key& key) const {
+    return get(key).has_value();
+}
+
+// Retrieves the value associated with a key without taking any lock.
+CONCURRENT_TEMPLATE
+optional<Value> CONCURRENT_TYPE::get(const Key& key) const {
+    size_t hash_val = hasher(key);
+    EpochReclaimer::ReadGuard guard(reclaimer);
+    if (Node* node = findNode(*table.load(memory_order_acquire), key, hash_val)) {
+        return node->value.load(memory_order_acquire);
+    }
+    return nullopt;
+}
+
+// Read-only subscript.
+CONCURRENT_TEMPLATE
+Value CONCURRENT_TYPE::operator[](const Key& key) const {
+    return get(key).value_or(Value());
+}
+
+// Returns the keys present in the slot array current at the time of the call.
+CONCURRENT_TEMPLATE
+vector<Key> CONCURRENT_TYPE::keys() const {
+    vector<Key> allKeys;
+    EpochReclaimer::ReadGuard guard(reclaimer);
+    const Table& current = *table.load(memory_order_acquire);
+    for (size_t i = 0; i < current.capacity; i++) {
+        Node* node = current.slots[i].load(memory_order_acquire);
+        if (node != nullptr && node != tombstone()) {
+            allKeys.push_back(node->key);
+        }
+    }
+    return allKeys;
+}
+
+// Calculates and returns the current load factor (alpha = size / capacity).
+CONCURRENT_TEMPLATE
+double CONCURRENT_TYPE::alpha() const {
+    return static_cast<double>(size()) / static_cast<double>(capacity());
+}
+
+// Returns the total number of slots available in the table (capacity).
+CONCURRENT_TEMPLATE
+size_t CONCURRENT_TYPE::capacity() const {
+    EpochReclaimer::ReadGuard guard(reclaimer);
+    return table.load(memory_order_acquire)->capacity;
+}
+
+// Returns the number of elements currently stored in the table (size).
+CONCURRENT_TEMPLATE
+size_t CONCURRENT_TYPE::size() const {
+    return currentSize.load(memory_order_relaxed);
+}
+
+// Follows the probe sequence until the key or a never-used slot is found.
+CONCURRENT_TEMPLATE
+auto CONCURRENT_TYPE::findNode(const Table& current, const Key& key, size_t hash) const -> Node* {
+    for (size_t step = 0; step < current.capacity; step++) {
+        Node* node = current.slots[probeIndex(hash, step, current.capacity)].load(memory_order_acquire);
+        if (node == nullptr) {
+            return nullptr;
+        }
+        if (node != tombstone() && node->hash == hash && keyEqual(node->key, key)) {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+// Replaces the slot array while holding the writer gate exclusively. Readers keep using
+// the old array until the new one is published; the old one is retired, not freed.
+CONCURRENT_TEMPLATE
+void CONCURRENT_TYPE::grow(const Table* seen) {
+    unique_lock<shared_mutex> gate(writerGate);
+    Table* current = table.load(memory_order_acquire);
+    if (current != seen) {
+        return; // Another writer already resized.
+    }
+
+    // Mostly tombstones: rebuild at the same size. Otherwise double.
+    size_t live = currentSize.load(memory_order_relaxed);
+    size_t newCapacity = live < maxUsed(current->capacity) / 2 ? current->capacity : current->capacity * 2;
+
+    Table* next = new Table(newCapacity);
+    size_t used = 0;
+    for (size_t i = 0; i < current->capacity; i++) {
+        Node* node = current->slots[i].load(memory_order_relaxed);
+        if (node == nullptr || node == tombstone()) {
+            continue;
+        }
+        // Nodes carry their hash, so moving them never rehashes a key.
+        for (size_t step = 0; ; step++) {
+            atomic<Node*>& slot = next->slots[probeIndex(node->hash, step, newCapacity)];
+            if (slot.load(memory_order_relaxed) == nullptr) {
+                slot.store(node, memory_order_relaxed);
+                used++;
+                break;
+            }
+        }
+    }
+    next->used.store(used, memory_order_relaxed);
+
+    table.store(next, memory_order_release);
+    gate.unlock();
+    reclaimer.retire(current, [](void* p) { delete static_cast<Table*>(p); });
+}
+
+#undef CONCURRENT_TEMPLATE
+#undef CONCURRENT_TYPE
+
+#endif
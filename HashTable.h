@@ -4,86 +4,2063 @@
  * 11/3/2025
  *
  * HashTable.h
- * Defines the HashTable and HashTableBucket classes
+ * Defines the BasicHashTable and BasicHashTableBucket class templates, a hash table
+ * using open addressing with a custom probing sequence. HashTable and HashTableBucket
+ * are the string-to-int instantiations.
  */
 
 #ifndef HASHTABLE_H
 #define HASHTABLE_H
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <array>
+#include <chrono>
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <concepts>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include <span>
+#include <random>
+#include <bit>
 #include <optional> // Required for returning optional values from get()
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 using namespace std;
 
 // Enum defining the three possible states of a hash table bucket.
-enum class BucketType {
+enum class BucketType : uint8_t {
     NORMAL, // Contains valid key-value data.
     ESS,    // Empty Since Start: never used.
     EAR     // Empty After Remove: previously contained data, now logically deleted.
 };
 
-// Represents a single storage unit within the hash table.
-class HashTableBucket {
+// Statistics hooks. Defining HASHTABLE_STATS (CMake option HASHTABLE_STATS) compiles
+// them in; otherwise they expand to nothing and stats() reports only the bucket census.
+#ifdef HASHTABLE_STATS
+#define HASHTABLE_STAT(...) __VA_ARGS__
+#else
+#define HASHTABLE_STAT(...)
+#endif
+
+// Snapshot of a table's statistics, returned by BasicHashTable::stats().
+struct HashTableStats {
+    // Probe lengths are bucket counts per operation, over both arrays during a resize.
+    // Entry i counts operations that examined i + 1 buckets; the last entry also counts
+    // every longer probe.
+    static constexpr size_t HISTOGRAM_SIZE = 16;
+
+    bool enabled = false;                          // False when built without HASHTABLE_STATS.
+    array<uint64_t, HISTOGRAM_SIZE> hitProbes{};   // Searches that found their key.
+    array<uint64_t, HISTOGRAM_SIZE> missProbes{};  // Searches that did not (including new inserts).
+    uint64_t maxProbeLength = 0;                   // Longest probe seen.
+
+    uint64_t inserts = 0;          // Successful inserts.
+    uint64_t duplicateInserts = 0; // Inserts rejected because the key was present.
+    uint64_t removes = 0;          // Successful removes.
+    uint64_t failedRemoves = 0;    // Removes of absent keys.
+    uint64_t lookups = 0;          // get, contains, find and batched lookups.
+    uint64_t resizes = 0;          // Rehashes started, including tombstone purges.
+    uint64_t reseeds = 0;          // Hash reseeds after an over-long probe.
+    uint64_t resizeNanoseconds = 0; // Time spent starting rehashes and migrating buckets.
+
+    // Bucket census over both arrays, taken when the snapshot is made.
+    size_t normalBuckets = 0;
+    size_t essBuckets = 0;
+    size_t earBuckets = 0;
+
+    // Returns the snapshot as a single JSON object.
+    string toJson() const {
+        ostringstream out;
+        auto histogram = [&](const char* name, const array<uint64_t, HISTOGRAM_SIZE>& counts) {
+            out << "\"" << name << "\":[";
+            for (size_t i = 0; i < counts.size(); i++) {
+                out << (i ? "," : "") << counts[i];
+            }
+            out << "],";
+        };
+        out << "{\"enabled\":" << (enabled ? "true" : "false") << ",";
+        histogram("hitProbes", hitProbes);
+        histogram("missProbes", missProbes);
+        out << "\"maxProbeLength\":" << maxProbeLength
+            << ",\"inserts\":" << inserts << ",\"duplicateInserts\":" << duplicateInserts
+            << ",\"removes\":" << removes << ",\"failedRemoves\":" << failedRemoves
+            << ",\"lookups\":" << lookups << ",\"resizes\":" << resizes << ",\"reseeds\":" << reseeds
+            << ",\"resizeNanoseconds\":" << resizeNanoseconds
+            << ",\"normalBuckets\":" << normalBuckets << ",\"essBuckets\":" << essBuckets
+            << ",\"earBuckets\":" << earBuckets << "}";
+        return out.str();
+    }
+};
+
+// A statistics counter updated with relaxed atomics, so concurrent readers of a table
+// (const lookups under a shared lock) never lose counts. Copying reads the value.
+class RelaxedCounter {
 public:
+    RelaxedCounter() = default;
+    RelaxedCounter(const RelaxedCounter& other): value(other.load()) {}
+    RelaxedCounter& operator=(const RelaxedCounter& other) {
+        value.store(other.load(), memory_order_relaxed);
+        return *this;
+    }
+
+    void operator++(int) { value.fetch_add(1, memory_order_relaxed); }
+    void operator+=(uint64_t n) { value.fetch_add(n, memory_order_relaxed); }
+    // Raises the value to n if it is lower.
+    void raiseTo(uint64_t n) {
+        uint64_t current = load();
+        while (current < n && !value.compare_exchange_weak(current, n, memory_order_relaxed)) {}
+    }
+    uint64_t load() const { return value.load(memory_order_relaxed); }
+
+private:
+    atomic<uint64_t> value{0};
+};
+
+// The live counters behind HashTableStats.
+struct HashTableCounters {
+    array<RelaxedCounter, HashTableStats::HISTOGRAM_SIZE> hitProbes;
+    array<RelaxedCounter, HashTableStats::HISTOGRAM_SIZE> missProbes;
+    RelaxedCounter maxProbeLength;
+    RelaxedCounter inserts;
+    RelaxedCounter duplicateInserts;
+    RelaxedCounter removes;
+    RelaxedCounter failedRemoves;
+    RelaxedCounter lookups;
+    RelaxedCounter resizes;
+    RelaxedCounter reseeds;
+    RelaxedCounter resizeNanoseconds;
+
+    // Adds one probe of the given length to the hit or miss histogram.
+    void recordProbe(bool hit, size_t length) {
+        auto& histogram = hit ? hitProbes : missProbes;
+        histogram[min(max<size_t>(length, 1), HashTableStats::HISTOGRAM_SIZE) - 1]++;
+        maxProbeLength.raiseTo(length);
+    }
+
+    // Copies the counters into a stats snapshot.
+    void copyTo(HashTableStats& stats) const {
+        for (size_t i = 0; i < HashTableStats::HISTOGRAM_SIZE; i++) {
+            stats.hitProbes[i] = hitProbes[i].load();
+            stats.missProbes[i] = missProbes[i].load();
+        }
+        stats.maxProbeLength = maxProbeLength.load();
+        stats.inserts = inserts.load();
+        stats.duplicateInserts = duplicateInserts.load();
+        stats.removes = removes.load();
+        stats.failedRemoves = failedRemoves.load();
+        stats.lookups = lookups.load();
+        stats.resizes = resizes.load();
+        stats.reseeds = reseeds.load();
+        stats.resizeNanoseconds = resizeNanoseconds.load();
+    }
+};
+
+// Hints the CPU to start loading the cache line at address. No-op on unknown compilers.
+inline void prefetchRead(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 1);
+#else
+    (void)address;
+#endif
+}
+
+// --- Hash and equality policies ---
+
+// Keys that can be hashed and compared as raw bytes: fixed-width structs with no padding.
+template <typename T>
+concept ByteComparable = is_trivially_copyable_v<T> && has_unique_object_representations_v<T>;
+
+// Default hash policy. Integers and enums are run through a 64-bit mixer, since
+// std::hash is the identity for them and sequential IDs would otherwise collide in
+// patterns. Types without std::hash but with a unique byte representation are hashed
+// as bytes (FNV-1a). Everything else uses std::hash.
+template <typename Key>
+struct DefaultHash {
+    size_t operator()(const Key& key) const {
+        if constexpr (is_integral_v<Key> || is_enum_v<Key>) {
+            uint64_t x = static_cast<uint64_t>(key);
+            x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+            x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+            return static_cast<size_t>(x);
+        } else if constexpr (requires { hash<Key>()(key); }) {
+            return hash<Key>()(key);
+        } else {
+            static_assert(ByteComparable<Key>, "Key needs std::hash or a padding-free trivially copyable layout");
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&key);
+            uint64_t h = 0xcbf29ce484222325ULL;
+            for (size_t i = 0; i < sizeof(Key); i++) {
+                h = (h ^ bytes[i]) * 0x100000001b3ULL;
+            }
+            return static_cast<size_t>(h);
+        }
+    }
+};
+
+// Default equality policy. Uses operator== when available and compares bytes otherwise.
+template <typename Key>
+struct DefaultKeyEqual {
+    bool operator()(const Key& a, const Key& b) const {
+        if constexpr (equality_comparable<Key>) {
+            return a == b;
+        } else {
+            static_assert(ByteComparable<Key>, "Key needs operator== or a padding-free trivially copyable layout");
+            return memcmp(&a, &b, sizeof(Key)) == 0;
+        }
+    }
+};
+
+// String keys hash and compare through string_view so lookups can take a
+// string_view or const char* without building a temporary string. The standard
+// guarantees hash<string_view> agrees with hash<string>.
+template <>
+struct DefaultHash<string> {
+    using is_transparent = void;
+    size_t operator()(string_view key) const {
+        return hash<string_view>()(key);
+    }
+};
+
+template <>
+struct DefaultKeyEqual<string> {
+    using is_transparent = void;
+    bool operator()(string_view a, string_view b) const {
+        return a == b;
+    }
+};
+
+// Bundled hash policies. Both hash strings through string_view (transparent, like
+// DefaultHash<string>) and other keys as their bytes, so they need ByteComparable keys
+// apart from strings. Integers are hashed through the same byte path.
+namespace hash_detail {
 
-    string key;          // The key string.
-    int value;           // The associated integer value.
+inline uint64_t read64(const unsigned char* p) { uint64_t v; memcpy(&v, p, 8); return v; }
+inline uint64_t read32(const unsigned char* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+// 64x64 -> 128-bit multiply folded to 64 bits.
+inline uint64_t foldedMultiply(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t aHi = a >> 32, aLo = a & 0xffffffff, bHi = b >> 32, bLo = b & 0xffffffff;
+    uint64_t loLo = aLo * bLo, hiLo = aHi * bLo, loHi = aLo * bHi, hiHi = aHi * bHi;
+    uint64_t cross = (loLo >> 32) + (hiLo & 0xffffffff) + loHi;
+    uint64_t hi = hiHi + (hiLo >> 32) + (cross >> 32);
+    uint64_t lo = (cross << 32) | (loLo & 0xffffffff);
+    return lo ^ hi;
+#endif
+}
+
+// wyhash-style: 16 or 48 bytes per round through folded multiplies.
+inline uint64_t fastHashBytes(const void* data, size_t length, uint64_t seed) {
+    constexpr uint64_t P0 = 0xa0761d6478bd642fULL, P1 = 0xe7037ed1a0b428dbULL;
+    constexpr uint64_t P2 = 0x8ebc6af09c88c6e3ULL, P3 = 0x589965cc75374cc3ULL;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    seed ^= foldedMultiply(seed ^ P0, P1);
+    uint64_t a = 0, b = 0;
+    if (length <= 16) {
+        if (length >= 4) {
+            size_t mid = (length >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + mid);
+            b = (read32(p + length - 4) << 32) | read32(p + length - 4 - mid);
+        } else if (length > 0) {
+            a = (uint64_t(p[0]) << 16) | (uint64_t(p[length >> 1]) << 8) | p[length - 1];
+        }
+    } else {
+        size_t remaining = length;
+        if (remaining > 48) {
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = foldedMultiply(read64(p) ^ P1, read64(p + 8) ^ seed);
+                seed1 = foldedMultiply(read64(p + 16) ^ P2, read64(p + 24) ^ seed1);
+                seed2 = foldedMultiply(read64(p + 32) ^ P3, read64(p + 40) ^ seed2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (remaining > 16) {
+            seed = foldedMultiply(read64(p) ^ P1, read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+        a = read64(p + remaining - 16);
+        b = read64(p + remaining - 8);
+    }
+    return foldedMultiply(P1 ^ length, foldedMultiply(a ^ P1, b ^ seed));
+}
+
+// SipHash-1-3 keyed by (k0, k1).
+inline uint64_t sipHashBytes(const void* data, size_t length, uint64_t k0, uint64_t k1) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t v0 = k0 ^ 0x736f6d6570736575ULL, v1 = k1 ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = k0 ^ 0x6c7967656e657261ULL, v3 = k1 ^ 0x7465646279746573ULL;
+    auto round = [&]() {
+        v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+        v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+    };
+    size_t whole = length & ~size_t(7);
+    for (size_t i = 0; i < whole; i += 8) {
+        uint64_t m = read64(p + i);
+        v3 ^= m; round(); v0 ^= m;
+    }
+    uint64_t last = uint64_t(length) << 56;
+    for (size_t i = whole; i < length; i++) {
+        last |= uint64_t(p[i]) << (8 * (i - whole));
+    }
+    v3 ^= last; round(); v0 ^= last;
+    v2 ^= 0xff;
+    round(); round(); round();
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+} // namespace hash_detail
+
+// Fast unseeded hash for trusted keys; much quicker than std::hash on long strings.
+template <typename Key>
+struct FastHash {
+    size_t operator()(const Key& key) const {
+        static_assert(ByteComparable<Key>, "FastHash needs string keys or a padding-free trivially copyable layout");
+        return static_cast<size_t>(hash_detail::fastHashBytes(&key, sizeof(Key), 0));
+    }
+};
+
+template <>
+struct FastHash<string> {
+    using is_transparent = void;
+    size_t operator()(string_view key) const {
+        return static_cast<size_t>(hash_detail::fastHashBytes(key.data(), key.size(), 0));
+    }
+};
+
+// Seed handling shared by the SeededHash policies.
+class SeededHashBase {
+public:
+    SeededHashBase() { reseed(); }
+    explicit SeededHashBase(array<uint64_t, 2> seed): keys(seed) {}
+
+    array<uint64_t, 2> seed() const { return keys; }
+    void setSeed(array<uint64_t, 2> seed) { keys = seed; }
+    // Draws a fresh random seed.
+    void reseed() {
+        random_device device;
+        for (uint64_t& k : keys) {
+            k = (uint64_t(device()) << 32) | device();
+        }
+    }
+
+protected:
+    size_t hashBytes(const void* data, size_t length) const {
+        return static_cast<size_t>(hash_detail::sipHashBytes(data, length, keys[0], keys[1]));
+    }
+
+private:
+    array<uint64_t, 2> keys{};
+};
+
+// Randomly seeded SipHash-1-3 for keys an attacker may choose: without the seed,
+// colliding keys cannot be computed offline. Each default-constructed policy draws its
+// own seed, and tables reseed it when a probe grows too long.
+template <typename Key>
+struct SeededHash : SeededHashBase {
+    using SeededHashBase::SeededHashBase;
+    size_t operator()(const Key& key) const {
+        static_assert(ByteComparable<Key>, "SeededHash needs string keys or a padding-free trivially copyable layout");
+        return hashBytes(&key, sizeof(Key));
+    }
+};
+
+template <>
+struct SeededHash<string> : SeededHashBase {
+    using is_transparent = void;
+    using SeededHashBase::SeededHashBase;
+    size_t operator()(string_view key) const {
+        return hashBytes(key.data(), key.size());
+    }
+};
+
+// Hash policies with a seed that tables can save, restore and replace.
+template <typename Hash>
+concept SeedableHash = requires(Hash hash, const Hash& constHash) {
+    { constHash.seed() } -> same_as<array<uint64_t, 2>>;
+    hash.setSeed(constHash.seed());
+    hash.reseed();
+};
+
+// True when both policies accept keys other than Key itself (heterogeneous lookup).
+template <typename Hash, typename KeyEqual>
+concept TransparentPolicies = requires {
+    typename Hash::is_transparent;
+    typename KeyEqual::is_transparent;
+};
+
+// Types that can be written to a table snapshot: raw bytes, or strings as length plus bytes.
+template <typename T>
+concept SnapshotField = is_trivially_copyable_v<T> || same_as<T, string>;
+
+// Represents a single storage unit within the hash table. Keys and values are
+// stored inline, so trivially copyable types never allocate per bucket.
+template <typename Key, typename Value>
+class BasicHashTableBucket {
+public:
+
+    Key key;             // The key.
+    Value value;         // The associated value.
     BucketType type;     // The state of the bucket (NORMAL, ESS, EAR).
+    size_t hash = 0;     // Cached hash of key; valid while the bucket is NORMAL.
 
     // Initializes type to ESS.
-    HashTableBucket();
-    // Initializes with data, setting type to NORMAL.
-    HashTableBucket(string key, int value);
-    // Loads key-value data into the bucket.
-    void load(string key, int value);
+    BasicHashTableBucket():
+        key(), value(), type(BucketType::ESS) {}
+    // Initializes with data, setting type to NORMAL. hash must come from the owning
+    // table's hash policy, since the table compares and rehashes by the cached value.
+    BasicHashTableBucket(Key key, Value value, size_t hash):
+        key(std::move(key)), value(std::move(value)), type(BucketType::NORMAL), hash(hash) {}
+
+    // Loads key-value data into the bucket with a hash from the table's hash policy.
+    void load(Key key, Value value, size_t hash) {
+        this->key = std::move(key);
+        this->value = std::move(value);
+        this->hash = hash;
+        this->type = BucketType::NORMAL;
+    }
     // Returns true if the bucket is available for insertion (ESS or EAR).
-    bool isEmpty() const;
+    bool isEmpty() const {
+        return type == BucketType::ESS || type == BucketType::EAR;
+    }
+    // Returns true if the bucket is NORMAL and holds key. Compares hashes before keys.
+    template <typename K, typename KeyEqual>
+    bool holds(const K& key, size_t hash, const KeyEqual& equal) const {
+        return type == BucketType::NORMAL && this->hash == hash && equal(this->key, key);
+    }
 
     // Stream output operator for displaying the bucket's content.
-    friend ostream& operator<<(ostream& os, const HashTableBucket& bucket);
+    friend ostream& operator<<(ostream& os, const BasicHashTableBucket& bucket) {
+        if (bucket.type == BucketType::NORMAL) {
+            // Only output if the bucket holds valid data.
+            os << "<" << bucket.key << ", " << bucket.value << ">";
+        }
+        return os;
+    }
+
+};
+
+// The random permutation of the offsets 1..capacity-1 used by the probe sequence,
+// computed on demand instead of stored. Step i is mixed by a bijection on the
+// smallest power-of-two range holding every step (odd multiplies, xor-shifts and an
+// add, all modulo 2^bits); results past the last step are mixed again until they
+// fall inside it (cycle walking), which keeps the map a permutation of the steps.
+// Only the seeds are stored, so resizing never allocates or shuffles offsets.
+class OffsetPermutation {
+public:
+
+    OffsetPermutation() = default;
+    // Seeds the permutation for a table of the given capacity.
+    OffsetPermutation(size_t capacity, uint64_t seed):
+        count(capacity > 0 ? capacity - 1 : 0) {
+        size_t bits = count > 1 ? bit_width(count - 1) : 0;
+        mask = bits == 0 ? 0 : (~size_t(0) >> (64 - bits));
+        shift = max<size_t>(bits / 2, 1);
+        mt19937_64 rng(seed);
+        multiplier1 = rng() | 1; // Odd multipliers are invertible modulo 2^bits.
+        multiplier2 = rng() | 1;
+        addend = rng();
+    }
+
+    // Returns the offset for probe step i + 1, a value in [1, capacity).
+    size_t operator[](size_t i) const {
+        size_t x = mix(i);
+        while (x >= count) {
+            x = mix(x);
+        }
+        return x + 1;
+    }
+    // Number of offsets (capacity - 1).
+    size_t size() const { return count; }
+
+private:
+    size_t count = 0;       // Number of offsets.
+    size_t mask = 0;        // 2^bits - 1, the range the mixer permutes.
+    size_t shift = 1;       // Xor-shift distance, half the range's bits.
+    uint64_t multiplier1 = 1;
+    uint64_t multiplier2 = 1;
+    uint64_t addend = 0;
+
+    // A bijection on [0, mask]; each step is invertible on its own.
+    size_t mix(size_t x) const {
+        x = (x * multiplier1) & mask;
+        x ^= x >> shift;
+        x = (x * multiplier2 + addend) & mask;
+        x ^= x >> shift;
+        return x;
+    }
+};
+
+// Walks the probe sequence for a key one index at a time: the home index first,
+// then (homeIndex + offset) mod capacity for each offset. Nothing is precomputed, so
+// a hit on the home bucket touches a single bucket and allocates nothing. Capacity
+// is a power of two, so the wrap-around is a mask rather than a division.
+template <typename Offsets>
+class ProbeSequence {
+public:
+
+    ProbeSequence(size_t homeIndex, const Offsets& offsets, size_t capacity):
+        homeIndex(homeIndex), offsets(&offsets), mask(capacity - 1) {}
 
+    // Returns the bucket index for the current step.
+    size_t index() const {
+        return step == 0 ? homeIndex : (homeIndex + (*offsets)[step - 1]) & mask;
+    }
+    // Returns true once every index in the sequence has been visited.
+    bool done() const { return step > offsets->size(); }
+    // Advances to the next index in the sequence.
+    void next() { step++; }
+
+private:
+    size_t homeIndex;        // First index probed.
+    const Offsets* offsets;  // Shared offset permutation of the owning table.
+    size_t mask;             // Capacity the offsets were generated for, minus one.
+    size_t step = 0;         // 0 for the home index, i for offsets[i - 1].
 };
 
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+class ShardedHashTable;
+
 // Implements the main hash table structure.
-class HashTable {
+template <typename Key,
+          typename Value,
+          typename Hash = DefaultHash<Key>,
+          typename KeyEqual = DefaultKeyEqual<Key>,
+          typename Allocator = allocator<pair<const Key, Value>>>
+class BasicHashTable {
 public:
 
+    using Bucket = BasicHashTableBucket<Key, Value>;
+
     // Default capacity for initialization.
     static constexpr size_t DEFAULT_INITIAL_CAPACITY = 8;
-    // Constructor; initializes the table structure.
-    HashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY);
+    // Keys handled per round by the batched operations: all are hashed and their home
+    // buckets prefetched before any of them is probed.
+    static constexpr size_t BATCH_SIZE = 16;
+    // Number of old buckets moved into the new array by each insert/remove/operator[]
+    // while a resize is in progress. Must be at least 2 so the migration always
+    // finishes before the new array itself reaches the resize threshold.
+    static constexpr size_t MIGRATION_STEP = 8;
+    // Highest shrink threshold setShrinkThreshold accepts. Halving capacity C leaves C old
+    // buckets to drain at MIGRATION_STEP per operation, and each operation raises
+    // size + tombstones by at most 1. The drain therefore finishes before the C/4 growth
+    // trigger of the halved array while size < C * (1/4 - 1/MIGRATION_STEP). It is also
+    // capped at 1/8 so the halved array starts under a quarter full, which makes churn
+    // purge tombstones instead of doubling back.
+    static constexpr double MAX_SHRINK_THRESHOLD =
+        min(0.125, 0.25 - 1.0 / MIGRATION_STEP);
+    static_assert(MAX_SHRINK_THRESHOLD > 0, "MIGRATION_STEP too small to ever shrink");
+    // Default load below which a remove halves the capacity (see setShrinkThreshold).
+    static constexpr double DEFAULT_SHRINK_THRESHOLD = MAX_SHRINK_THRESHOLD;
+    // Buckets an insert may probe before a SeedableHash policy is reseeded and the table
+    // rebuilt. Random keys at load 1/2 practically never get near this; keys crafted to
+    // collide under the old seed scatter under the new one.
+    static constexpr size_t MAX_PROBE_LENGTH = 64;
+    // Fewest items per thread in parallel builds and rebuilds; smaller jobs use fewer threads.
+    static constexpr size_t PARALLEL_GRAIN = 1 << 14;
+
+    // Constructor; initializes the table structure. initCapacity is rounded up to a power of two.
+    BasicHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY,
+                   const Hash& hasher = Hash(),
+                   const KeyEqual& keyEqual = KeyEqual(),
+                   const Allocator& alloc = Allocator());
 
     // Core Mutators and Accessors
-    bool insert(string key, size_t value);
-    bool remove(string key);
-    bool contains(const string& key) const;
-    // Retrieves value. Returns optional<int> to handle key absence.
-    optional<int> get(const string& key) const;
-    // Subscript operator. Returns reference to value (potential UB if key not found).
-    int& operator[](const string& key);
+    // insert copies an lvalue key only once it is known to be new; rvalue keys are moved.
+    bool insert(const Key& key, Value value) { return emplace(key, std::move(value)); }
+    bool insert(Key&& key, Value value) { return emplace(std::move(key), std::move(value)); }
+    // Inserts key with a value built from valueArgs. The stored Key is constructed from key
+    // only if the insert succeeds, so a string_view or const char* key allocates once.
+    template <typename K, typename... Args>
+    bool emplace(K&& key, Args&&... valueArgs);
+    bool remove(const Key& key) { return removeHashed(key, hashKey(key)); }
+    bool contains(const Key& key) const { return find(key, hashKey(key)) != nullptr; }
+    // Retrieves value. Returns optional<Value> to handle key absence.
+    optional<Value> get(const Key& key) const { return getValue(key); }
+    // Subscript operator. Returns a reference to key's value, first inserting a
+    // value-initialized entry if key is absent (as std::map does). One probe either way.
+    Value& operator[](const Key& key) { return subscript(key); }
+    Value& operator[](Key&& key) { return subscript(std::move(key)); }
+
+    // Heterogeneous lookups, enabled when Hash and KeyEqual are transparent (string keys
+    // by default). These take e.g. a string_view or const char* and never build a Key.
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    bool remove(const K& key) { return removeHashed(key, hashKey(key)); }
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    bool contains(const K& key) const { return find(key, hashKey(key)) != nullptr; }
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    optional<Value> get(const K& key) const { return getValue(key); }
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    Value& operator[](const K& key) { return subscript(key); }
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    auto find(const K& key) { return iteratorAt<iterator>(*this, find(key, hashKey(key))); }
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    auto find(const K& key) const { return iteratorAt<const_iterator>(*this, find(key, hashKey(key))); }
+
+    // Batched operations. Each handles the first min(keys.size(), results.size()) keys,
+    // writing results[i] for keys[i], and overlaps the cache misses of a whole round of
+    // BATCH_SIZE keys instead of stalling on each one in turn.
+    void getMany(span<const Key> keys, span<optional<Value>> results) const { getBatch(keys, results); }
+    // Returns the number of keys found.
+    size_t containsMany(span<const Key> keys, span<bool> results) const { return containsBatch(keys, results); }
+    // Inserts entries in order; inserted[i] reports whether entries[i] was new. Returns the number inserted.
+    size_t insertMany(span<const pair<Key, Value>> entries, span<bool> inserted);
+
+    // Builds a table presized for entries on up to threads threads (0 for one per core):
+    // keys are hashed in parallel, then each claims its bucket with an atomic compare-and-
+    // swap. Duplicate keys keep their first occurrence, as with insertMany.
+    static BasicHashTable build(span<const pair<Key, Value>> entries, size_t threads = 0,
+                                const Hash& hasher = Hash(), const KeyEqual& keyEqual = KeyEqual(),
+                                const Allocator& alloc = Allocator());
+
+    // Heterogeneous batched lookups, e.g. over a span<const string_view>.
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    void getMany(span<const K> keys, span<optional<Value>> results) const { getBatch(keys, results); }
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    size_t containsMany(span<const K> keys, span<bool> results) const { return containsBatch(keys, results); }
+
     // Returns a vector containing all keys in the table.
-    vector<string> keys() const;
+    vector<Key> keys() const;
+    // Rebuilds the table at its current capacity, dropping every EAR bucket.
+    void compact();
+    // Grows the table so n entries fit without a resize, and keeps automatic shrinking
+    // from going below that capacity.
+    void reserve(size_t n);
+    // Rebuilds the table at the smallest capacity that holds its entries below the
+    // growth threshold, dropping every EAR bucket.
+    void shrinkToFit();
+    // Sets the load below which a remove halves the capacity, never going under the
+    // constructor's (or the last reserve's) capacity. 0 disables automatic shrinking.
+    // Clamped to at most MAX_SHRINK_THRESHOLD (0.125 at MIGRATION_STEP 8). The halved
+    // table then finishes migrating before it can need to grow, and churn purges
+    // tombstones in place instead of doubling straight back.
+    void setShrinkThreshold(double load);
+    // Sets the threads compact, reserve and shrinkToFit rebuild with (default 1, 0 for one
+    // per core). Automatic growth stays incremental and single-threaded.
+    void setRehashThreads(size_t threads);
+
+    // Forward iterator over the NORMAL buckets of both arrays. Dereferencing yields a
+    // pair of references to the bucket's key and value, so nothing is copied:
+    //     for (auto [key, value] : table) { value++; }
+    // Any insert, remove or operator[] invalidates every iterator, since each one may
+    // move entries while a resize is migrating.
+    template <bool IsConst>
+    class BasicIterator {
+        using BucketPtr = conditional_t<IsConst, const Bucket*, Bucket*>;
+    public:
+        using iterator_concept = forward_iterator_tag;
+        using iterator_category = input_iterator_tag; // Proxy references rule out the legacy forward tag.
+        using value_type = pair<const Key&, conditional_t<IsConst, const Value&, Value&>>;
+        using reference = value_type;
+        using difference_type = ptrdiff_t;
+        // Holds the pair of references so operator-> has something to point at.
+        struct pointer {
+            value_type entry;
+            const value_type* operator->() const { return &entry; }
+        };
+
+        BasicIterator() = default;
+
+        reference operator*() const { return {bucket->key, bucket->value}; }
+        pointer operator->() const { return {**this}; }
+        BasicIterator& operator++() {
+            ++bucket;
+            skipEmpty();
+            return *this;
+        }
+        BasicIterator operator++(int) {
+            BasicIterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const BasicIterator& other) const { return bucket == other.bucket; }
+        // iterator converts to const_iterator.
+        operator BasicIterator<true>() const requires (!IsConst) {
+            BasicIterator<true> result;
+            result.bucket = bucket;
+            result.arrayEnd = arrayEnd;
+            result.nextBegin = nextBegin;
+            result.nextEnd = nextEnd;
+            return result;
+        }
+
+    private:
+        friend class BasicHashTable;
+        template <bool> friend class BasicIterator;
+
+        BucketPtr bucket = nullptr;     // Current bucket.
+        BucketPtr arrayEnd = nullptr;   // End of the array bucket is in.
+        BucketPtr nextBegin = nullptr;  // The old array, still to be visited (equal to
+        BucketPtr nextEnd = nullptr;    // nextEnd once there is nothing left to visit).
+
+        // Advances to the next NORMAL bucket, moving on to the old array when the current
+        // one runs out. Stops at the end of the last array, which is what end() holds.
+        void skipEmpty() {
+            while (true) {
+                while (bucket != arrayEnd && bucket->type != BucketType::NORMAL) {
+                    ++bucket;
+                }
+                if (bucket != arrayEnd || nextBegin == nextEnd) {
+                    return;
+                }
+                bucket = nextBegin;
+                arrayEnd = nextEnd;
+                nextBegin = nextEnd;
+            }
+        }
+    };
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    iterator begin() { return makeIterator<iterator>(*this, false); }
+    iterator end() { return makeIterator<iterator>(*this, true); }
+    const_iterator begin() const { return makeIterator<const_iterator>(*this, false); }
+    const_iterator end() const { return makeIterator<const_iterator>(*this, true); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    // Returns an iterator to key's entry, or end() if key is absent.
+    iterator find(const Key& key) { return iteratorAt<iterator>(*this, find(key, hashKey(key))); }
+    const_iterator find(const Key& key) const { return iteratorAt<const_iterator>(*this, find(key, hashKey(key))); }
+    // Inserts key with a value built from valueArgs unless key is already present, in which
+    // case nothing is constructed. Returns an iterator to key's entry and whether it was
+    // inserted. Finding the key and finding its insertion bucket take a single probe.
+    template <typename K, typename... Args>
+    pair<iterator, bool> tryEmplace(K&& key, Args&&... valueArgs);
+    // Inserts key with value, or assigns value to key's entry if it is already present.
+    // Returns an iterator to the entry and whether it was inserted. One probe either way.
+    template <typename K, typename V>
+    pair<iterator, bool> insertOrAssign(K&& key, V&& value);
+
+    // Calls visit(key, value) for every entry in a single pass over the buckets.
+    template <typename Visitor> void forEach(Visitor visit);
+    template <typename Visitor> void forEach(Visitor visit) const;
+    // Removes every entry for which pred(key, value) is true in a single pass, leaving
+    // EAR buckets behind as remove() does. Returns the number of entries removed.
+    template <typename Predicate> size_t eraseIf(Predicate pred);
 
     // Status Metrics
     double alpha() const;     // Calculates and returns the load factor (size/capacity).
     size_t capacity() const;  // Returns the total bucket count.
     size_t size() const;      // Returns the number of stored elements.
+    size_t tombstones() const; // Returns the number of EAR buckets in the current array.
+    bool isMigrating() const; // True while buckets from a previous resize remain in the old array.
+    // Returns the collected counters plus a bucket census. Counters are relaxed atomics,
+    // so concurrent const lookups (e.g. ShardedHashTable readers) count safely; the
+    // snapshot itself is not taken atomically across counters.
+    HashTableStats stats() const;
+    void resetStats();        // Zeroes the collected counters.
+
+    // Binary snapshot of the buckets, cached hashes and any in-progress migration, in
+    // native byte order. load() puts every entry back in the bucket it was saved from,
+    // so nothing is hashed or probed. Both return false on I/O errors; load() also
+    // rejects files written for other key/value types or by a different hash function,
+    // and leaves the table unchanged when it fails.
+    bool save(const string& path) const requires SnapshotField<Key> && SnapshotField<Value>;
+    bool load(const string& path) requires SnapshotField<Key> && SnapshotField<Value>;
 
     // Stream output operator for displaying the entire table.
-    friend ostream& operator<<(ostream& os, const HashTable& hashTable);
+    friend ostream& operator<<(ostream& os, const BasicHashTable& hashTable) {
+        for (size_t i = 0; i < hashTable.tableData.size(); ++i) {
+            const auto& bucket = hashTable.tableData[i];
+
+            if (bucket.type == BucketType::NORMAL) {
+                os << "Bucket " << i << ": " << bucket << endl;
+            }
+        }
+        for (size_t i = 0; i < hashTable.oldTableData.size(); ++i) {
+            const auto& bucket = hashTable.oldTableData[i];
+
+            if (bucket.type == BucketType::NORMAL) {
+                os << "Old bucket " << i << ": " << bucket << endl;
+            }
+        }
+        return os;
+    }
 
 private:
-    vector<HashTableBucket> tableData; // The underlying vector of buckets.
-    vector<size_t> offsets;           // Randomized offsets for the probe sequence.
+    // Shards hash each key once and hand the hash to the *Hashed/find internals.
+    friend class ShardedHashTable<Key, Value, Hash, KeyEqual, Allocator>;
+
+    using BucketAllocator = typename allocator_traits<Allocator>::template rebind_alloc<Bucket>;
+    using BucketArray = vector<Bucket, BucketAllocator>;
+    using Probe = ProbeSequence<OffsetPermutation>;
+
+    [[no_unique_address]] Hash hasher;       // Hash policy.
+    [[no_unique_address]] KeyEqual keyEqual; // Key equality policy.
+
+    BucketArray tableData;            // The underlying vector of buckets.
+    OffsetPermutation offsets;        // Randomized offsets for the probe sequence.
     size_t currentSize = 0;           // Current element count.
     size_t currentCapacity = 0;       // Current size of the tableData vector.
+    size_t tombstoneCount = 0;        // EAR buckets in tableData; they lengthen probes like live keys.
+    size_t minCapacity = 1;           // Automatic shrinking never goes below this.
+    double shrinkThreshold = DEFAULT_SHRINK_THRESHOLD; // Load that triggers a shrink; 0 disables.
+
+    // Incremental resize state. After a resize the previous array stays here and is
+    // drained MIGRATION_STEP buckets at a time; every key lives in exactly one array.
+    BucketArray oldTableData;         // Buckets not yet migrated (empty when idle).
+    OffsetPermutation oldOffsets;     // Probe offsets matching oldTableData.
+    size_t migrateIndex = 0;          // Next oldTableData index to migrate.
+
+    size_t reseedCount = 0;           // Times the hash policy has been reseeded.
+    size_t rehashThreads = 1;         // Threads for synchronous rebuilds (see setRehashThreads).
+    // Set for tables whose hashes are computed by their owner (ShardedHashTable shards),
+    // which must never reseed on their own.
+    bool externalHashes = false;
+
+    HASHTABLE_STAT(mutable HashTableCounters statsData;) // Counters; const lookups update them too.
+
+    // Shared implementations of the Key and heterogeneous overloads.
+    template <typename K, typename... Args> bool emplaceHashed(size_t& hash, K&& key, Args&&... valueArgs);
+    template <typename K> void getBatch(span<const K> keys, span<optional<Value>> results) const;
+    template <typename K> size_t containsBatch(span<const K> keys, span<bool> results) const;
+    template <typename K> bool removeHashed(const K& key, size_t hash);
+    template <typename K> optional<Value> getValue(const K& key) const;
+    template <typename K> Value& subscript(K&& key);
+
+    // The single probe behind every insert. Returns the NORMAL bucket holding key and true,
+    // or the empty bucket a new entry for key belongs in and false. If the probe was too
+    // long and the table reseeded, hash is updated to the key's new hash.
+    template <typename K> pair<Bucket*, bool> findOrReserve(const K& key, size_t& hash);
+    // Loads a new entry into a bucket returned by findOrReserve().
+    template <typename K, typename... Args> void fill(Bucket& bucket, size_t hash, K&& key, Args&&... valueArgs);
+
+    // Builds the begin (atEnd false) or end iterator of a table.
+    template <typename Iterator, typename Table> static Iterator makeIterator(Table& table, bool atEnd);
+    // Builds an iterator to a bucket of a table, or its end iterator for nullptr.
+    template <typename Iterator, typename Table, typename BucketPtr>
+    static Iterator iteratorAt(Table& table, BucketPtr bucket);
+
+    // Hashes a key. Computed once per operation and cached in the bucket it lands in.
+    template <typename K> size_t hashKey(const K& key) const;
+    // Hashes keys[0..count) into hashes and prefetches each one's home bucket.
+    template <typename K> void prepareBatch(const K* keys, size_t count, size_t* hashes) const;
+    // Maps a hash to its first probe index in an array of the given power-of-two capacity.
+    // Multiplying by 2^64 / phi (Fibonacci hashing) mixes every bit of the hash into the top
+    // bits, which are kept, so weak hashes such as sequential integers still spread out.
+    static size_t homeIndex(size_t hash, size_t capacity) {
+        int bits = countr_zero(capacity);
+        return bits == 0 ? 0 : static_cast<size_t>((hash * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+    }
+    // Starts the probe sequence for a hash in the current table.
+    Probe probe(size_t hash) const;
+    static Probe probe(size_t hash, const OffsetPermutation& probeOffsets, size_t capacity);
+    // Returns the index of the NORMAL bucket holding key, or nullopt if it is not in the array.
+    // Adds the number of buckets examined to probes.
+    template <typename K>
+    optional<size_t> locate(const BucketArray& buckets, const OffsetPermutation& probeOffsets,
+                            const K& key, size_t hash, size_t& probes) const;
+    // Returns the NORMAL bucket holding key in either array, or nullptr if it is absent.
+    template <typename K> const Bucket* find(const K& key, size_t hash) const;
+    template <typename K> const Bucket* find(const K& key, size_t hash, size_t& probes) const;
+    template <typename K> Bucket* find(const K& key, size_t hash);
 
     // Maintenance functions
-    void resize();        // Doubles capacity and rehashes elements.
-    void generateOffsets(); // Creates the random probe sequence permutation.
+    void resize();        // Doubles capacity, or purges tombstones at the same capacity.
+    void shrinkIfSparse();  // Halves capacity after removes leave the table nearly empty.
+    void rehash(size_t newCapacity);  // Starts migrating every element into a fresh array.
+    void migrate(size_t bucketCount); // Moves up to bucketCount old buckets into tableData.
+    // Loads target with source's entry under hash. The entry is moved only when its key and
+    // value both move without throwing; otherwise both are copied and source is left as it
+    // was, so a throw never strands a moved-from key or value in a NORMAL bucket.
+    static void relocate(Bucket& target, Bucket& source, size_t hash);
+    void finishMigration();           // Moves every remaining old bucket into tableData.
+    void generateOffsets(); // Seeds the random probe sequence permutation for the current capacity.
+    void reseedHash();      // Replaces the hash seed and rebuilds the table under the new hashes.
+    // Rebuilds both arrays into one of newCapacity buckets in a single parallel pass.
+    void rebuild(size_t newCapacity);
+
+    // Parallel placement shared by build() and rebuild(). Item i has key keyAt(i) (nullptr
+    // to skip it) and hash hashAt(i); each claims the first free bucket on its probe
+    // sequence in a capacity-sized claim array, which then holds item index + 1 per bucket.
+    // If keys may repeat, a bucket already claimed by an equal key goes to the lower index.
+    template <typename KeyAt, typename HashAt>
+    vector<atomic<size_t>> claimBuckets(size_t itemCount, size_t capacity, const OffsetPermutation& probeOffsets,
+                                        KeyAt keyAt, HashAt hashAt, bool keysMayRepeat, size_t threads) const;
+    // Loads every claimed bucket of target with loadAt(bucket, item). Returns the count.
+    template <typename LoadAt>
+    static size_t fillClaimed(BucketArray& target, const vector<atomic<size_t>>& claims, LoadAt loadAt, size_t threads);
+    // Runs work(begin, end) over [0, count) in up to threads contiguous chunks, one per
+    // thread, the first on the calling thread. Rethrows the first exception after all join.
+    template <typename Work> static void parallelFor(size_t count, size_t threads, Work work);
+
+    // Snapshot file layout: the header, then each array (current, then old while
+    // migrating) as one state byte per bucket followed by the hashes, values and keys
+    // of its NORMAL buckets, each in its own section.
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t keySize;     // sizeof(Key), or 0 for string keys.
+        uint32_t valueSize;   // sizeof(Value), or 0 for string values.
+        uint32_t reserved;
+        uint64_t size;
+        uint64_t tombstones;
+        uint64_t capacity;
+        uint64_t oldCapacity;  // 0 unless a migration was in progress.
+        uint64_t migrateIndex;
+        uint64_t hashSeed[2];  // The hash policy's seed, or zeros if it has none.
+    };
+    static constexpr char SNAPSHOT_MAGIC[8] = {'H', 'T', 'S', 'N', 'A', 'P', '\0', '\0'};
+    static constexpr uint32_t SNAPSHOT_VERSION = 2;
+    template <typename T> static constexpr uint32_t snapshotSize() { return same_as<T, string> ? 0 : sizeof(T); }
+
+    static void saveArray(ostream& out, const BucketArray& buckets);
+    static bool loadArray(istream& in, BucketArray& buckets);
+    template <typename T, typename Field> static void saveFields(ostream& out, const BucketArray& buckets, Field field);
+    template <typename T, typename Field> static bool loadFields(istream& in, BucketArray& buckets, Field field);
+    // Bytes between the read position and the end of the stream, or 0 if unknown.
+    static uint64_t bytesLeft(istream& in);
 
 };
 
-#endif
\ No newline at end of file
+// The string-to-int table and bucket used throughout the project.
+using HashTableBucket = BasicHashTableBucket<string, int>;
+using HashTable = BasicHashTable<string, int>;
+
+// --- BasicHashTable ---
+
+#define HASHTABLE_TEMPLATE template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+#define HASHTABLE_TYPE BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>
+
+// Constructor. Initializes the table with a given capacity.
+HASHTABLE_TEMPLATE
+HASHTABLE_TYPE::BasicHashTable(size_t initCapacity, const Hash& hasher, const KeyEqual& keyEqual,
+                               const Allocator& alloc):
+    hasher(hasher), keyEqual(keyEqual),
+    tableData(BucketAllocator(alloc)), oldTableData(BucketAllocator(alloc)) {
+    static_assert(sizeof(size_t) == 8, "homeIndex keeps the top bits of a 64-bit product");
+    currentCapacity = bit_ceil(max<size_t>(initCapacity, 1));
+    minCapacity = currentCapacity;
+    currentSize = 0;
+    tableData.resize(currentCapacity); // Allocate space for the table.
+
+    generateOffsets(); // Create the random permutation probe sequence.
+}
+
+// Inserts a key-value pair into the table. Returns true on success, false on duplicate key.
+HASHTABLE_TEMPLATE
+template <typename K, typename... Args>
+bool HASHTABLE_TYPE::emplace(K&& key, Args&&... valueArgs) {
+    size_t hash_val = hashKey(key);
+    return emplaceHashed(hash_val, std::forward<K>(key), std::forward<Args>(valueArgs)...);
+}
+
+// Inserts a key whose hash has already been computed.
+HASHTABLE_TEMPLATE
+template <typename K, typename... Args>
+bool HASHTABLE_TYPE::emplaceHashed(size_t& hash_val, K&& key, Args&&... valueArgs) {
+    auto [bucket, found] = findOrReserve(key, hash_val);
+    if (found) {
+        HASHTABLE_STAT(statsData.duplicateInserts++;)
+        return false; // Duplicate found, insertion failed.
+    }
+    fill(*bucket, hash_val, std::forward<K>(key), std::forward<Args>(valueArgs)...);
+    return true;
+}
+
+// Inserts unless the key is present. Either way the result points at key's entry.
+HASHTABLE_TEMPLATE
+template <typename K, typename... Args>
+auto HASHTABLE_TYPE::tryEmplace(K&& key, Args&&... valueArgs) -> pair<iterator, bool> {
+    size_t hash_val = hashKey(key);
+    auto [bucket, found] = findOrReserve(key, hash_val);
+    if (found) {
+        HASHTABLE_STAT(statsData.duplicateInserts++;)
+    } else {
+        fill(*bucket, hash_val, std::forward<K>(key), std::forward<Args>(valueArgs)...);
+    }
+    return {iteratorAt<iterator>(*this, bucket), !found};
+}
+
+// Inserts the key or overwrites the value of the entry already holding it.
+HASHTABLE_TEMPLATE
+template <typename K, typename V>
+auto HASHTABLE_TYPE::insertOrAssign(K&& key, V&& value) -> pair<iterator, bool> {
+    size_t hash_val = hashKey(key);
+    auto [bucket, found] = findOrReserve(key, hash_val);
+    if (found) {
+        bucket->value = std::forward<V>(value);
+    } else {
+        fill(*bucket, hash_val, std::forward<K>(key), std::forward<V>(value));
+    }
+    return {iteratorAt<iterator>(*this, bucket), !found};
+}
+
+// Walks the key's probe sequence once, through the old array first while a resize is in
+// progress, remembering the first empty bucket in the current array as it goes.
+HASHTABLE_TEMPLATE
+template <typename K>
+auto HASHTABLE_TYPE::findOrReserve(const K& key, size_t& hash_val) -> pair<Bucket*, bool> {
+    migrate(MIGRATION_STEP);
+
+    size_t probes = 0;
+    // Keys that have not been migrated yet are still found in the old array.
+    if (isMigrating()) {
+        if (optional<size_t> idx = locate(oldTableData, oldOffsets, key, hash_val, probes)) {
+            HASHTABLE_STAT(statsData.recordProbe(true, probes);)
+            return {&oldTableData[*idx], true};
+        }
+    }
+
+    // insertion tracks the first available empty slot found (EAR or ESS).
+    Bucket* insertion = nullptr;
+
+    // Iterate through the probe sequence: home index followed by indices offset by the random permutation.
+    for (Probe seq = probe(hash_val); !seq.done(); seq.next()) {
+        Bucket& currentBucket = tableData[seq.index()];
+        probes++;
+
+        if (currentBucket.type == BucketType::NORMAL) {
+            // Found data. Check for the key (keys are only compared when the hashes match).
+            if (currentBucket.holds(key, hash_val, keyEqual)) {
+                HASHTABLE_STAT(statsData.recordProbe(true, probes);)
+                return {&currentBucket, true};
+            }
+        } else { // Bucket is ESS (never used) or EAR (deleted).
+            if (insertion == nullptr) {
+                insertion = &currentBucket;
+            }
+            if (currentBucket.type == BucketType::ESS) {
+                break; // ESS terminates the probe sequence.
+            }
+            // If EAR, continue probing: the key may sit further along the sequence.
+        }
+    }
+    HASHTABLE_STAT(statsData.recordProbe(false, probes);)
+
+    // A probe this long means many keys share the key's hashes, which for a seeded
+    // policy points at crafted keys. Reseed, rebuild, and place the key by its new hash.
+    if constexpr (SeedableHash<Hash>) {
+        if (probes > MAX_PROBE_LENGTH && !externalHashes) {
+            reseedHash();
+            hash_val = hashKey(key);
+            for (Probe seq = probe(hash_val); !seq.done(); seq.next()) {
+                if (tableData[seq.index()].isEmpty()) {
+                    insertion = &tableData[seq.index()];
+                    break;
+                }
+            }
+        }
+    }
+
+    // Resize once live keys plus tombstones reach half the buckets. Tombstones count
+    // because probes walk past them exactly as they do past live keys. The key is known
+    // to be absent, so in the new array it takes the first empty bucket on its sequence.
+    if (currentSize + tombstoneCount >= currentCapacity / 2.0) {
+        resize();
+        migrate(MIGRATION_STEP);
+        for (Probe seq = probe(hash_val); !seq.done(); seq.next()) {
+            if (tableData[seq.index()].isEmpty()) {
+                insertion = &tableData[seq.index()];
+                break;
+            }
+        }
+    }
+    return {insertion, false};
+}
+
+// Loads a new entry. The Key and Value are only constructed here, once the key is known to be new.
+HASHTABLE_TEMPLATE
+template <typename K, typename... Args>
+void HASHTABLE_TYPE::fill(Bucket& bucket, size_t hash_val, K&& key, Args&&... valueArgs) {
+    if (bucket.type == BucketType::EAR) {
+        tombstoneCount--; // Reusing a tombstone.
+    }
+    bucket.load(Key(std::forward<K>(key)), Value(std::forward<Args>(valueArgs)...), hash_val);
+    currentSize++;
+    HASHTABLE_STAT(statsData.inserts++;)
+}
+
+// Removes a key-value pair from the table. Returns true on success, false if key not found.
+HASHTABLE_TEMPLATE
+template <typename K>
+bool HASHTABLE_TYPE::removeHashed(const K& key, size_t hash) {
+    migrate(MIGRATION_STEP);
+
+    Bucket* bucket = nullptr;
+    size_t probes = 0;
+    if (optional<size_t> idx = locate(tableData, offsets, key, hash, probes)) {
+        bucket = &tableData[*idx];
+        tombstoneCount++; // Old-array tombstones are dropped with the array, so only these count.
+    } else if (isMigrating()) {
+        if (optional<size_t> oldIdx = locate(oldTableData, oldOffsets, key, hash, probes)) {
+            bucket = &oldTableData[*oldIdx];
+        }
+    }
+    HASHTABLE_STAT(statsData.recordProbe(bucket != nullptr, probes);)
+    if (bucket == nullptr) {
+        HASHTABLE_STAT(statsData.failedRemoves++;)
+        return false; // Key was not found in either array.
+    }
+    HASHTABLE_STAT(statsData.removes++;)
+
+    // Key found. Mark the bucket as Empty After Remove (EAR) to preserve the probe chain.
+    bucket->type = BucketType::EAR;
+    currentSize--;
+    shrinkIfSparse();
+    return true; // Removal successful.
+}
+
+// Retrieves the value associated with a key. Returns an optional<Value> (nullopt if key not found).
+HASHTABLE_TEMPLATE
+template <typename K>
+optional<Value> HASHTABLE_TYPE::getValue(const K& key) const {
+    if (const Bucket* bucket = find(key, hashKey(key))) {
+        return bucket->value; // Key found. Return the value.
+    }
+    return nullopt; // Key is not in the table.
+}
+
+// Overloads the subscript operator (operator[]). Returns a reference to key's value,
+// inserting a value-initialized entry first if key is absent.
+HASHTABLE_TEMPLATE
+template <typename K>
+Value& HASHTABLE_TYPE::subscript(K&& key) {
+    size_t hash_val = hashKey(key);
+    auto [bucket, found] = findOrReserve(key, hash_val);
+    if (!found) {
+        fill(*bucket, hash_val, std::forward<K>(key));
+    }
+    return bucket->value;
+}
+
+// Looks up a batch of keys, BATCH_SIZE at a time: hash and prefetch the round, then probe it.
+HASHTABLE_TEMPLATE
+template <typename K>
+void HASHTABLE_TYPE::getBatch(span<const K> keys, span<optional<Value>> results) const {
+    size_t count = min(keys.size(), results.size());
+    size_t hashes[BATCH_SIZE];
+
+    for (size_t start = 0; start < count; start += BATCH_SIZE) {
+        size_t round = min(BATCH_SIZE, count - start);
+        prepareBatch(&keys[start], round, hashes);
+
+        for (size_t i = 0; i < round; i++) {
+            const Bucket* bucket = find(keys[start + i], hashes[i]);
+            results[start + i] = bucket ? optional<Value>(bucket->value) : nullopt;
+        }
+    }
+}
+
+// Same pipeline as getBatch, recording only whether each key is present.
+HASHTABLE_TEMPLATE
+template <typename K>
+size_t HASHTABLE_TYPE::containsBatch(span<const K> keys, span<bool> results) const {
+    size_t count = min(keys.size(), results.size());
+    size_t hashes[BATCH_SIZE];
+    size_t found = 0;
+
+    for (size_t start = 0; start < count; start += BATCH_SIZE) {
+        size_t round = min(BATCH_SIZE, count - start);
+        prepareBatch(&keys[start], round, hashes);
+
+        for (size_t i = 0; i < round; i++) {
+            results[start + i] = find(keys[start + i], hashes[i]) != nullptr;
+            found += results[start + i];
+        }
+    }
+    return found;
+}
+
+// Inserts a batch in order. Hashes are computed and home buckets prefetched per round;
+// the inserts themselves stay sequential, so duplicates within the batch keep the first.
+HASHTABLE_TEMPLATE
+size_t HASHTABLE_TYPE::insertMany(span<const pair<Key, Value>> entries, span<bool> inserted) {
+    size_t count = min(entries.size(), inserted.size());
+    size_t hashes[BATCH_SIZE];
+    size_t insertedCount = 0;
+
+    for (size_t start = 0; start < count; start += BATCH_SIZE) {
+        size_t round = min(BATCH_SIZE, count - start);
+        for (size_t i = 0; i < round; i++) {
+            hashes[i] = hashKey(entries[start + i].first);
+            prefetchRead(&tableData[homeIndex(hashes[i], currentCapacity)]);
+        }
+
+        for (size_t i = 0; i < round; i++) {
+            const pair<Key, Value>& entry = entries[start + i];
+            size_t seeds = reseedCount;
+            inserted[start + i] = emplaceHashed(hashes[i], entry.first, entry.second);
+            insertedCount += inserted[start + i];
+            // A reseed makes the rest of the round's hashes stale.
+            for (size_t j = i + 1; seeds != reseedCount && j < round; j++) {
+                hashes[j] = hashKey(entries[start + j].first);
+            }
+        }
+    }
+    return insertedCount;
+}
+
+// Presizes like reserve(entries.size()), hashes every key in parallel, claims buckets
+// in parallel, then loads the winners into their buckets in parallel.
+HASHTABLE_TEMPLATE
+auto HASHTABLE_TYPE::build(span<const pair<Key, Value>> entries, size_t threads, const Hash& hasher,
+                           const KeyEqual& keyEqual, const Allocator& alloc) -> BasicHashTable {
+    BasicHashTable table(2 * entries.size(), hasher, keyEqual, alloc);
+    HASHTABLE_STAT(auto start = chrono::steady_clock::now();)
+
+    vector<size_t> hashes(entries.size());
+    parallelFor(entries.size(), threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            hashes[i] = table.hashKey(entries[i].first);
+        }
+    });
+    vector<atomic<size_t>> claims = table.claimBuckets(
+        entries.size(), table.currentCapacity, table.offsets,
+        [&](size_t i) { return &entries[i].first; }, [&](size_t i) { return hashes[i]; }, true, threads);
+    table.currentSize = fillClaimed(table.tableData, claims, [&](Bucket& bucket, size_t i) {
+        bucket.load(entries[i].first, entries[i].second, hashes[i]);
+    }, threads);
+
+    HASHTABLE_STAT(
+        table.statsData.inserts += table.currentSize;
+        table.statsData.duplicateInserts += entries.size() - table.currentSize;
+        table.statsData.resizeNanoseconds += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    )
+    return table;
+}
+
+// Returns a vector containing all keys currently stored in the table.
+HASHTABLE_TEMPLATE
+vector<Key> HASHTABLE_TYPE::keys() const {
+    vector<Key> allKeys;
+    for (const auto& bucket : tableData) {
+        if (bucket.type == BucketType::NORMAL) {
+            allKeys.push_back(bucket.key);
+        }
+    }
+    // Include entries that have not been migrated yet (migrated ones are EAR).
+    for (const auto& bucket : oldTableData) {
+        if (bucket.type == BucketType::NORMAL) {
+            allKeys.push_back(bucket.key);
+        }
+    }
+    return allKeys;
+}
+
+// Visits the current array, then the old array while a resize is in progress.
+HASHTABLE_TEMPLATE
+template <typename Visitor>
+void HASHTABLE_TYPE::forEach(Visitor visit) {
+    for (BucketArray* buckets : {&tableData, &oldTableData}) {
+        for (Bucket& bucket : *buckets) {
+            if (bucket.type == BucketType::NORMAL) {
+                visit(as_const(bucket.key), bucket.value);
+            }
+        }
+    }
+}
+
+HASHTABLE_TEMPLATE
+template <typename Visitor>
+void HASHTABLE_TYPE::forEach(Visitor visit) const {
+    for (const BucketArray* buckets : {&tableData, &oldTableData}) {
+        for (const Bucket& bucket : *buckets) {
+            if (bucket.type == BucketType::NORMAL) {
+                visit(bucket.key, bucket.value);
+            }
+        }
+    }
+}
+
+// Marks every matching bucket EAR. Only tombstones in the current array are counted,
+// as in removeHashed().
+HASHTABLE_TEMPLATE
+template <typename Predicate>
+size_t HASHTABLE_TYPE::eraseIf(Predicate pred) {
+    size_t erased = 0;
+    for (BucketArray* buckets : {&tableData, &oldTableData}) {
+        for (Bucket& bucket : *buckets) {
+            if (bucket.type == BucketType::NORMAL && pred(as_const(bucket.key), as_const(bucket.value))) {
+                bucket.type = BucketType::EAR;
+                erased++;
+                if (buckets == &tableData) {
+                    tombstoneCount++;
+                }
+            }
+        }
+    }
+    currentSize -= erased;
+    shrinkIfSparse();
+    HASHTABLE_STAT(statsData.removes += erased;)
+    return erased;
+}
+
+// Iterators to a single bucket carry on into the old array from the current one, as
+// begin() does.
+HASHTABLE_TEMPLATE
+template <typename Iterator, typename Table, typename BucketPtr>
+Iterator HASHTABLE_TYPE::iteratorAt(Table& table, BucketPtr bucket) {
+    if (bucket == nullptr) {
+        return makeIterator<Iterator>(table, true);
+    }
+    auto* first = table.tableData.data();
+    auto* firstEnd = first + table.tableData.size();
+    auto* oldEnd = table.oldTableData.data() + table.oldTableData.size();
+
+    Iterator it;
+    it.bucket = bucket;
+    if (!less<>()(bucket, first) && less<>()(bucket, firstEnd)) {
+        it.arrayEnd = firstEnd;
+        it.nextBegin = table.isMigrating() ? table.oldTableData.data() : oldEnd;
+    } else {
+        it.arrayEnd = oldEnd;
+        it.nextBegin = oldEnd;
+    }
+    it.nextEnd = oldEnd;
+    return it;
+}
+
+// Begin iterators start at the first NORMAL bucket of the current array; end iterators
+// sit one past the last bucket of the last array to be visited.
+HASHTABLE_TEMPLATE
+template <typename Iterator, typename Table>
+Iterator HASHTABLE_TYPE::makeIterator(Table& table, bool atEnd) {
+    auto* first = table.tableData.data();
+    auto* firstEnd = first + table.tableData.size();
+    auto* old = table.oldTableData.data();
+    auto* oldEnd = old + table.oldTableData.size();
+
+    Iterator it;
+    if (atEnd) {
+        it.bucket = it.arrayEnd = table.isMigrating() ? oldEnd : firstEnd;
+        it.nextBegin = it.nextEnd = it.bucket;
+        return it;
+    }
+    it.bucket = first;
+    it.arrayEnd = firstEnd;
+    it.nextBegin = table.isMigrating() ? old : oldEnd;
+    it.nextEnd = oldEnd;
+    it.skipEmpty();
+    return it;
+}
+
+// Purges tombstones synchronously. Unlike the purge triggered by an insert, the table
+// is fully rebuilt when this returns.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::compact() {
+    if (tombstoneCount > 0 || isMigrating()) {
+        rebuild(currentCapacity);
+    }
+}
+
+// Presizes for n entries. A new key is stored while size + tombstones < capacity / 2,
+// so 2n buckets take n keys without resizing.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::reserve(size_t n) {
+    size_t needed = bit_ceil(max<size_t>(2 * n, 1));
+    minCapacity = max(minCapacity, needed);
+    if (needed > currentCapacity) {
+        rebuild(needed);
+    }
+}
+
+// Rebuilds at the smallest power of two above twice the size, which also becomes
+// the new floor for automatic shrinking.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::shrinkToFit() {
+    size_t target = bit_ceil(2 * currentSize + 1);
+    minCapacity = target;
+    if (target < currentCapacity || tombstoneCount > 0 || isMigrating()) {
+        rebuild(min(target, currentCapacity));
+    }
+}
+
+// Sets the automatic shrink threshold, clamped to [0, MAX_SHRINK_THRESHOLD].
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::setShrinkThreshold(double load) {
+    shrinkThreshold = clamp(load, 0.0, MAX_SHRINK_THRESHOLD);
+}
+
+// Sets the thread count used by rebuild().
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::setRehashThreads(size_t threads) {
+    rehashThreads = threads;
+}
+
+// Calculates and returns the current load factor (alpha = size / capacity).
+HASHTABLE_TEMPLATE
+double HASHTABLE_TYPE::alpha() const {
+    return static_cast<double>(currentSize) / static_cast<double>(currentCapacity);
+}
+
+// Returns the total number of buckets available in the table (capacity).
+HASHTABLE_TEMPLATE
+size_t HASHTABLE_TYPE::capacity() const {
+    return currentCapacity;
+}
+
+// Returns the number of elements currently stored in the table (size).
+HASHTABLE_TEMPLATE
+size_t HASHTABLE_TYPE::size() const {
+    return currentSize;
+}
+
+// Returns the number of tombstones (EAR buckets) in the current array.
+HASHTABLE_TEMPLATE
+size_t HASHTABLE_TYPE::tombstones() const {
+    return tombstoneCount;
+}
+
+// Copies the counters and counts the buckets of each type in both arrays.
+HASHTABLE_TEMPLATE
+HashTableStats HASHTABLE_TYPE::stats() const {
+    HashTableStats result;
+    HASHTABLE_STAT(statsData.copyTo(result); result.enabled = true;)
+    for (const BucketArray* buckets : {&tableData, &oldTableData}) {
+        for (const Bucket& bucket : *buckets) {
+            switch (bucket.type) {
+                case BucketType::NORMAL: result.normalBuckets++; break;
+                case BucketType::ESS: result.essBuckets++; break;
+                case BucketType::EAR: result.earBuckets++; break;
+            }
+        }
+    }
+    return result;
+}
+
+// Zeroes the collected counters. The bucket census is always taken fresh.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::resetStats() {
+    HASHTABLE_STAT(statsData = HashTableCounters();)
+}
+
+// Returns true while a resize is still moving buckets out of the old array.
+HASHTABLE_TEMPLATE
+bool HASHTABLE_TYPE::isMigrating() const {
+    return !oldTableData.empty();
+}
+
+// Hashes a key with the table's hash policy.
+HASHTABLE_TEMPLATE
+template <typename K>
+size_t HASHTABLE_TYPE::hashKey(const K& key) const {
+    return hasher(key);
+}
+
+// Hashes a round of keys and prefetches the home bucket of each in every live array,
+// so the round's cache misses overlap instead of being taken one probe at a time.
+HASHTABLE_TEMPLATE
+template <typename K>
+void HASHTABLE_TYPE::prepareBatch(const K* keys, size_t count, size_t* hashes) const {
+    for (size_t i = 0; i < count; i++) {
+        hashes[i] = hashKey(keys[i]);
+        prefetchRead(&tableData[homeIndex(hashes[i], currentCapacity)]);
+        if (isMigrating()) {
+            prefetchRead(&oldTableData[homeIndex(hashes[i], oldTableData.size())]);
+        }
+    }
+}
+
+// Starts the probe sequence for a hash in the current table.
+HASHTABLE_TEMPLATE
+auto HASHTABLE_TYPE::probe(size_t hash) const -> Probe {
+    return probe(hash, offsets, currentCapacity);
+}
+
+// Starts the probe sequence for a hash at its home index.
+HASHTABLE_TEMPLATE
+auto HASHTABLE_TYPE::probe(size_t hash, const OffsetPermutation& probeOffsets, size_t capacity) -> Probe {
+    return Probe(homeIndex(hash, capacity), probeOffsets, capacity);
+}
+
+// Follows the key's probe sequence through the given array until the key or an ESS bucket is found.
+HASHTABLE_TEMPLATE
+template <typename K>
+optional<size_t> HASHTABLE_TYPE::locate(const BucketArray& buckets, const OffsetPermutation& probeOffsets,
+                                        const K& key, size_t hash, size_t& probes) const {
+    for (Probe seq = probe(hash, probeOffsets, buckets.size()); !seq.done(); seq.next()) {
+        const Bucket& bucket = buckets[seq.index()];
+        probes++;
+
+        if (bucket.type == BucketType::NORMAL) {
+            if (bucket.holds(key, hash, keyEqual)) {
+                return seq.index(); // Key found.
+            }
+        } else if (bucket.type == BucketType::ESS) {
+            return nullopt; // ESS terminates the search. Key is not in this array.
+        }
+        // If EAR, continue probing.
+    }
+    return nullopt; // Probed all available slots without finding the key or an ESS.
+}
+
+// Looks in the current array, then in the old array while a resize is in progress.
+// Every call counts as one lookup in the statistics.
+HASHTABLE_TEMPLATE
+template <typename K>
+auto HASHTABLE_TYPE::find(const K& key, size_t hash) const -> const Bucket* {
+    size_t probes = 0;
+    const Bucket* bucket = find(key, hash, probes);
+    HASHTABLE_STAT(statsData.lookups++; statsData.recordProbe(bucket != nullptr, probes);)
+    return bucket;
+}
+
+HASHTABLE_TEMPLATE
+template <typename K>
+auto HASHTABLE_TYPE::find(const K& key, size_t hash, size_t& probes) const -> const Bucket* {
+    if (optional<size_t> idx = locate(tableData, offsets, key, hash, probes)) {
+        return &tableData[*idx];
+    }
+    // During a resize the key may not have been migrated yet.
+    if (isMigrating()) {
+        if (optional<size_t> idx = locate(oldTableData, oldOffsets, key, hash, probes)) {
+            return &oldTableData[*idx];
+        }
+    }
+    return nullptr;
+}
+
+HASHTABLE_TEMPLATE
+template <typename K>
+auto HASHTABLE_TYPE::find(const K& key, size_t hash) -> Bucket* {
+    return const_cast<Bucket*>(as_const(*this).find(key, hash));
+}
+
+// Called when the table reaches its load threshold. If most of the load is tombstones
+// the table is rebuilt at the same capacity, which leaves it under a quarter full;
+// otherwise the capacity doubles.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::resize() {
+    finishMigration(); // Settle the tombstone count before choosing.
+    rehash(tombstoneCount > currentSize ? currentCapacity : currentCapacity * 2);
+}
+
+// Starts halving the capacity once the load falls below the shrink threshold. Waits
+// for any migration to finish first, so a large purge shrinks one halving at a time.
+// The threshold is at most MAX_SHRINK_THRESHOLD, so the old array drains before the
+// halved one reaches its growth trigger and resize() never has to finish it in one go.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::shrinkIfSparse() {
+    if (shrinkThreshold > 0 && !isMigrating() && currentCapacity > minCapacity &&
+        currentSize < currentCapacity * shrinkThreshold) {
+        rehash(currentCapacity / 2);
+    }
+}
+
+// Swaps in an empty array of newCapacity buckets. Elements stay in the old array and
+// are moved over incrementally by migrate(), so no single operation pays for the
+// whole rehash, no key is copied, and peak memory is the two bucket arrays. The new
+// array is allocated before anything changes, so a failed allocation leaves the table
+// as it was. Tombstones are not carried over.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::rehash(size_t newCapacity) {
+    // A new rehash can only start once the previous one has drained.
+    finishMigration();
+    newCapacity = bit_ceil(max<size_t>(newCapacity, 1));
+    HASHTABLE_STAT(auto start = chrono::steady_clock::now();)
+
+    BucketArray newTableData(newCapacity, tableData.get_allocator()); // Allocate before touching the table.
+
+    oldTableData.swap(tableData);
+    tableData.swap(newTableData);
+    oldOffsets = offsets;
+    migrateIndex = 0;
+    tombstoneCount = 0;
+
+    currentCapacity = newCapacity;
+    generateOffsets();      // Generate a new random probe sequence for the new capacity.
+
+    HASHTABLE_STAT(
+        statsData.resizes++;
+        statsData.resizeNanoseconds += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    )
+}
+
+// Moves the next bucketCount buckets of the old array into the current table.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::migrate(size_t bucketCount) {
+    if (!isMigrating()) {
+        return;
+    }
+    HASHTABLE_STAT(auto start = chrono::steady_clock::now();)
+
+    size_t end = min(migrateIndex + bucketCount, oldTableData.size());
+    for (; migrateIndex < end; migrateIndex++) {
+        Bucket& bucket = oldTableData[migrateIndex];
+        if (bucket.type != BucketType::NORMAL) {
+            continue;
+        }
+
+        // The key cannot already be in the new table, so the first empty bucket wins.
+        // The cached hash picks the new home index without reading the key.
+        for (Probe seq = probe(bucket.hash); !seq.done(); seq.next()) {
+            Bucket& target = tableData[seq.index()];
+            if (target.isEmpty()) {
+                // A throw leaves the old bucket intact and migrateIndex on it, so the step
+                // can be retried.
+                bool reused = target.type == BucketType::EAR;
+                relocate(target, bucket, bucket.hash);
+                if (reused) {
+                    tombstoneCount--;
+                }
+                break;
+            }
+        }
+        // Leave a tombstone so keys further along the old chains stay reachable.
+        bucket.type = BucketType::EAR;
+    }
+
+    // Release the old array once it has been fully drained.
+    if (migrateIndex == oldTableData.size()) {
+        BucketArray(tableData.get_allocator()).swap(oldTableData);
+        oldOffsets = OffsetPermutation();
+        migrateIndex = 0;
+    }
+    HASHTABLE_STAT(statsData.resizeNanoseconds += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();)
+}
+
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::relocate(Bucket& target, Bucket& source, size_t hash) {
+    if constexpr (is_nothrow_move_constructible_v<Key> && is_nothrow_move_assignable_v<Key> &&
+                  is_nothrow_move_constructible_v<Value> && is_nothrow_move_assignable_v<Value>) {
+        target.load(std::move(source.key), std::move(source.value), hash);
+    } else {
+        // Copies into load()'s parameters; whichever is made first, source is untouched.
+        target.load(source.key, source.value, hash);
+    }
+}
+
+// Completes any in-progress migration in one pass.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::finishMigration() {
+    migrate(oldTableData.size());
+}
+
+// Rebuilds the table at the same capacity under a freshly seeded copy of the hash policy,
+// dropping tombstones. Unlike a resize this cannot be spread over later operations,
+// since every cached hash changes at once. The new array and hashes are computed before
+// anything moves, and entries are moved only when that cannot throw (see relocate()),
+// so a throw leaves the table as it was.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::reseedHash() {
+    if constexpr (SeedableHash<Hash>) {
+        finishMigration();
+        HASHTABLE_STAT(auto start = chrono::steady_clock::now();)
+
+        Hash newHasher = hasher;
+        newHasher.reseed();
+        BucketArray newTableData(currentCapacity, tableData.get_allocator());
+        vector<size_t> newHashes(currentCapacity);
+        for (size_t i = 0; i < currentCapacity; i++) {
+            if (tableData[i].type == BucketType::NORMAL) {
+                newHashes[i] = newHasher(tableData[i].key);
+            }
+        }
+
+        for (size_t i = 0; i < currentCapacity; i++) {
+            Bucket& bucket = tableData[i];
+            if (bucket.type != BucketType::NORMAL) {
+                continue;
+            }
+            for (Probe seq = probe(newHashes[i]); !seq.done(); seq.next()) {
+                Bucket& target = newTableData[seq.index()];
+                if (target.isEmpty()) {
+                    relocate(target, bucket, newHashes[i]);
+                    break;
+                }
+            }
+        }
+        tableData.swap(newTableData);
+        hasher = std::move(newHasher);
+        tombstoneCount = 0;
+        reseedCount++;
+
+        HASHTABLE_STAT(
+            statsData.reseeds++;
+            statsData.resizeNanoseconds += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        )
+    }
+}
+
+// Moves every NORMAL bucket of both arrays into a fresh array at once, instead of
+// migrating incrementally, using the cached hashes. Items are numbered across the current
+// array and then the old one. Entries are moved only when their key and value both move
+// without throwing (see relocate()); otherwise they are copied and the sources are only
+// released with the old arrays once every copy has succeeded, so a throw leaves the table
+// as it was.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::rebuild(size_t newCapacity) {
+    newCapacity = bit_ceil(max<size_t>(newCapacity, 1));
+    HASHTABLE_STAT(auto start = chrono::steady_clock::now();)
+
+    BucketArray newTableData(newCapacity, tableData.get_allocator()); // Allocate before touching the table.
+    OffsetPermutation newOffsets(newCapacity, newCapacity);
+    size_t currentCount = tableData.size();
+    auto bucketAt = [&](size_t i) -> Bucket& {
+        return i < currentCount ? tableData[i] : oldTableData[i - currentCount];
+    };
+
+    vector<atomic<size_t>> claims = claimBuckets(
+        currentCount + oldTableData.size(), newCapacity, newOffsets,
+        [&](size_t i) { Bucket& bucket = bucketAt(i); return bucket.type == BucketType::NORMAL ? &bucket.key : nullptr; },
+        [&](size_t i) { return bucketAt(i).hash; }, false, rehashThreads);
+    fillClaimed(newTableData, claims, [&](Bucket& target, size_t i) {
+        Bucket& bucket = bucketAt(i);
+        relocate(target, bucket, bucket.hash);
+    }, rehashThreads);
+
+    tableData.swap(newTableData);
+    BucketArray(tableData.get_allocator()).swap(oldTableData);
+    offsets = newOffsets;
+    oldOffsets = OffsetPermutation();
+    migrateIndex = 0;
+    tombstoneCount = 0;
+    currentCapacity = newCapacity;
+
+    HASHTABLE_STAT(
+        statsData.resizes++;
+        statsData.resizeNanoseconds += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    )
+}
+
+// Each item walks its probe sequence and compare-and-swaps its index into the first free
+// claim. Claims are never released (an equal key with a lower index only replaces one),
+// so every bucket an item passes stays held by a different key, and copies of one key
+// always meet at the first bucket any of them claimed.
+HASHTABLE_TEMPLATE
+template <typename KeyAt, typename HashAt>
+vector<atomic<size_t>> HASHTABLE_TYPE::claimBuckets(size_t itemCount, size_t capacity,
+                                                    const OffsetPermutation& probeOffsets, KeyAt keyAt,
+                                                    HashAt hashAt, bool keysMayRepeat, size_t threads) const {
+    vector<atomic<size_t>> claims(capacity);
+    parallelFor(itemCount, threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const Key* key = keyAt(i);
+            if (key == nullptr) {
+                continue;
+            }
+            size_t hash_val = hashAt(i);
+            for (Probe seq = probe(hash_val, probeOffsets, capacity); !seq.done(); seq.next()) {
+                atomic<size_t>& claim = claims[seq.index()];
+                size_t held = claim.load(memory_order_relaxed);
+                bool placed = false;
+                while (!placed) {
+                    if (held == 0) {
+                        placed = claim.compare_exchange_weak(held, i + 1, memory_order_relaxed);
+                    } else if (keysMayRepeat && hashAt(held - 1) == hash_val && keyEqual(*keyAt(held - 1), *key)) {
+                        // Same key: the earlier occurrence keeps the bucket.
+                        placed = held - 1 < i || claim.compare_exchange_weak(held, i + 1, memory_order_relaxed);
+                    } else {
+                        break; // Another key holds this bucket; keep probing.
+                    }
+                }
+                if (placed) {
+                    break;
+                }
+            }
+        }
+    });
+    return claims;
+}
+
+HASHTABLE_TEMPLATE
+template <typename LoadAt>
+size_t HASHTABLE_TYPE::fillClaimed(BucketArray& target, const vector<atomic<size_t>>& claims, LoadAt loadAt,
+                                   size_t threads) {
+    atomic<size_t> filled = 0;
+    parallelFor(claims.size(), threads, [&](size_t begin, size_t end) {
+        size_t count = 0;
+        for (size_t b = begin; b < end; b++) {
+            if (size_t held = claims[b].load(memory_order_relaxed)) {
+                loadAt(target[b], held - 1);
+                count++;
+            }
+        }
+        filled += count;
+    });
+    return filled;
+}
+
+HASHTABLE_TEMPLATE
+template <typename Work>
+void HASHTABLE_TYPE::parallelFor(size_t count, size_t threads, Work work) {
+    if (threads == 0) {
+        threads = max(thread::hardware_concurrency(), 1u);
+    }
+    size_t chunks = max<size_t>(min(threads, count / PARALLEL_GRAIN), 1);
+    if (chunks == 1) {
+        work(0, count);
+        return;
+    }
+
+    exception_ptr failure;
+    mutex failureLock;
+    auto guarded = [&](size_t begin, size_t end) {
+        try {
+            work(begin, end);
+        } catch (...) {
+            lock_guard<mutex> lock(failureLock);
+            failure = failure ? failure : current_exception();
+        }
+    };
+    vector<thread> workers;
+    workers.reserve(chunks - 1);
+    try {
+        for (size_t c = 1; c < chunks; c++) {
+            workers.emplace_back(guarded, count * c / chunks, count * (c + 1) / chunks);
+        }
+    } catch (...) {
+        // Could not start a thread: run the chunks that have none here.
+        for (size_t c = workers.size() + 1; c < chunks; c++) {
+            guarded(count * c / chunks, count * (c + 1) / chunks);
+        }
+    }
+    guarded(0, count / chunks);
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    if (failure) {
+        rethrow_exception(failure);
+    }
+}
+
+// Writes the table to path. See SnapshotHeader for the layout.
+HASHTABLE_TEMPLATE
+bool HASHTABLE_TYPE::save(const string& path) const requires SnapshotField<Key> && SnapshotField<Value> {
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    SnapshotHeader header{};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.keySize = snapshotSize<Key>();
+    header.valueSize = snapshotSize<Value>();
+    header.size = currentSize;
+    header.tombstones = tombstoneCount;
+    header.capacity = currentCapacity;
+    header.oldCapacity = oldTableData.size();
+    header.migrateIndex = migrateIndex;
+    if constexpr (SeedableHash<Hash>) {
+        array<uint64_t, 2> seed = hasher.seed();
+        memcpy(header.hashSeed, seed.data(), sizeof(header.hashSeed));
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    saveArray(out, tableData);
+    if (isMigrating()) {
+        saveArray(out, oldTableData);
+    }
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+// Reads a table written by save(). Everything is loaded into new arrays first and
+// only swapped in once the whole file has been read and checked.
+HASHTABLE_TEMPLATE
+bool HASHTABLE_TYPE::load(const string& path) requires SnapshotField<Key> && SnapshotField<Value> {
+    ifstream in(path, ios::binary);
+    SnapshotHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.version != SNAPSHOT_VERSION ||
+        header.keySize != snapshotSize<Key>() || header.valueSize != snapshotSize<Value>() ||
+        !has_single_bit(header.capacity) || (header.oldCapacity != 0 && !has_single_bit(header.oldCapacity)) ||
+        header.migrateIndex > header.oldCapacity) {
+        return false;
+    }
+    // Every bucket has a state byte in the file, so a capacity larger than the file is
+    // corrupt; reject it before allocating.
+    uint64_t left = bytesLeft(in);
+    if (header.capacity > left || header.oldCapacity > left - header.capacity) {
+        return false;
+    }
+
+    BucketArray newTableData(header.capacity, tableData.get_allocator());
+    BucketArray newOldTableData(header.oldCapacity, tableData.get_allocator());
+    if (!loadArray(in, newTableData) || (header.oldCapacity != 0 && !loadArray(in, newOldTableData))) {
+        return false;
+    }
+
+    // A seeded policy takes the saved seed, since the cached hashes were computed under it.
+    Hash loadedHasher = hasher;
+    if constexpr (SeedableHash<Hash>) {
+        array<uint64_t, 2> seed;
+        memcpy(seed.data(), header.hashSeed, sizeof(header.hashSeed));
+        loadedHasher.setSeed(seed);
+    }
+
+    // The bucket counts must agree with the header, and the cached hashes must match
+    // this table's hash function or every saved position would be wrong.
+    size_t normal = 0;
+    size_t ear = 0;
+    const Bucket* sample = nullptr;
+    for (const BucketArray* buckets : {&newTableData, &newOldTableData}) {
+        for (const Bucket& bucket : *buckets) {
+            if (bucket.type == BucketType::NORMAL) {
+                normal++;
+                sample = sample ? sample : &bucket;
+            } else if (bucket.type == BucketType::EAR && buckets == &newTableData) {
+                ear++;
+            }
+        }
+    }
+    if (normal != header.size || ear != header.tombstones || (sample && loadedHasher(sample->key) != sample->hash)) {
+        return false;
+    }
+
+    tableData.swap(newTableData);
+    oldTableData.swap(newOldTableData);
+    hasher = std::move(loadedHasher);
+    currentSize = header.size;
+    tombstoneCount = header.tombstones;
+    currentCapacity = header.capacity;
+    migrateIndex = header.oldCapacity != 0 ? header.migrateIndex : 0;
+    generateOffsets();
+    oldOffsets = header.oldCapacity != 0 ? OffsetPermutation(header.oldCapacity, header.oldCapacity) : OffsetPermutation();
+    return true;
+}
+
+// Writes one bucket array: states, then the hashes, values and keys of its NORMAL buckets.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::saveArray(ostream& out, const BucketArray& buckets) {
+    vector<uint8_t> states(buckets.size());
+    for (size_t i = 0; i < buckets.size(); i++) {
+        states[i] = static_cast<uint8_t>(buckets[i].type);
+    }
+    out.write(reinterpret_cast<const char*>(states.data()), states.size());
+
+    saveFields<size_t>(out, buckets, [](const Bucket& bucket) -> const size_t& { return bucket.hash; });
+    saveFields<Value>(out, buckets, [](const Bucket& bucket) -> const Value& { return bucket.value; });
+    saveFields<Key>(out, buckets, [](const Bucket& bucket) -> const Key& { return bucket.key; });
+}
+
+// Reads one bucket array written by saveArray() into buckets, which is already sized.
+HASHTABLE_TEMPLATE
+bool HASHTABLE_TYPE::loadArray(istream& in, BucketArray& buckets) {
+    vector<uint8_t> states(buckets.size());
+    if (!in.read(reinterpret_cast<char*>(states.data()), states.size())) {
+        return false;
+    }
+    for (size_t i = 0; i < buckets.size(); i++) {
+        if (states[i] > static_cast<uint8_t>(BucketType::EAR)) {
+            return false;
+        }
+        buckets[i].type = static_cast<BucketType>(states[i]);
+    }
+
+    return loadFields<size_t>(in, buckets, [](Bucket& bucket) -> size_t& { return bucket.hash; }) &&
+           loadFields<Value>(in, buckets, [](Bucket& bucket) -> Value& { return bucket.value; }) &&
+           loadFields<Key>(in, buckets, [](Bucket& bucket) -> Key& { return bucket.key; });
+}
+
+// Writes one field of every NORMAL bucket. Strings are written as all the lengths,
+// then all the characters back to back.
+HASHTABLE_TEMPLATE
+template <typename T, typename Field>
+void HASHTABLE_TYPE::saveFields(ostream& out, const BucketArray& buckets, Field field) {
+    if constexpr (same_as<T, string>) {
+        for (const Bucket& bucket : buckets) {
+            if (bucket.type == BucketType::NORMAL) {
+                uint64_t length = field(bucket).size();
+                out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            }
+        }
+        for (const Bucket& bucket : buckets) {
+            if (bucket.type == BucketType::NORMAL) {
+                out.write(field(bucket).data(), field(bucket).size());
+            }
+        }
+    } else {
+        for (const Bucket& bucket : buckets) {
+            if (bucket.type == BucketType::NORMAL) {
+                out.write(reinterpret_cast<const char*>(&field(bucket)), sizeof(T));
+            }
+        }
+    }
+}
+
+// Reads one field of every NORMAL bucket in the order saveFields() wrote them.
+HASHTABLE_TEMPLATE
+template <typename T, typename Field>
+bool HASHTABLE_TYPE::loadFields(istream& in, BucketArray& buckets, Field field) {
+    if constexpr (same_as<T, string>) {
+        vector<uint64_t> lengths;
+        for (const Bucket& bucket : buckets) {
+            if (bucket.type == BucketType::NORMAL) {
+                uint64_t length = 0;
+                if (!in.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+                    return false;
+                }
+                lengths.push_back(length);
+            }
+        }
+        // The characters follow, so the lengths cannot add up to more than the rest of
+        // the file. Checked before any string is sized from them.
+        uint64_t left = bytesLeft(in);
+        for (uint64_t length : lengths) {
+            if (length > left) {
+                return false;
+            }
+            left -= length;
+        }
+        size_t next = 0;
+        for (Bucket& bucket : buckets) {
+            if (bucket.type == BucketType::NORMAL) {
+                string& text = field(bucket);
+                text.resize(lengths[next++]);
+                if (!in.read(text.data(), text.size())) {
+                    return false;
+                }
+            }
+        }
+    } else {
+        for (Bucket& bucket : buckets) {
+            if (bucket.type == BucketType::NORMAL && !in.read(reinterpret_cast<char*>(&field(bucket)), sizeof(T))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+HASHTABLE_TEMPLATE
+uint64_t HASHTABLE_TYPE::bytesLeft(istream& in) {
+    streampos position = in.tellg();
+    if (position < 0 || !in.seekg(0, ios::end)) {
+        return 0;
+    }
+    streampos end = in.tellg();
+    in.seekg(position);
+    return end > position ? static_cast<uint64_t>(end - position) : 0;
+}
+
+// Seeds the probe offset permutation for the current capacity. The seed is the
+// capacity, so offsets are reproducible and tables built on different threads never
+// share random state.
+HASHTABLE_TEMPLATE
+void HASHTABLE_TYPE::generateOffsets() {
+    offsets = OffsetPermutation(currentCapacity, currentCapacity);
+}
+
+#undef HASHTABLE_TEMPLATE
+#undef HASHTABLE_TYPE
+#undef HASHTABLE_STAT
+
+#endif
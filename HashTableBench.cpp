@@ -0,0 +1,274 @@
+/**
+ * HashTableBench.cpp
+ * Throughput and latency benchmark for the hash table engines, with std::unordered_map
+ * as the baseline. Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+ *
+ * Usage: HashTableBench [--keys N] [--ops N] [--dist uniform|zipf] [--zipf S]
+ *                       [--engine all|hashtable|swiss|robinhood|compact|unordered_map] [--workload all|NAME]
+ *
+ * Workloads:
+ *   grow      insert N keys into a default-sized table (includes every resize)
+ *   presized  insert N keys into a table constructed with room for them
+ *   hit       look up keys that are present, drawn from the chosen distribution
+ *   miss      look up keys that were never inserted
+ *   churn     remove a present key and insert a new one, leaving tombstones behind
+ *
+ * Peak RSS is per process and never goes down, so run one engine per process
+ * (--engine NAME) when comparing memory.
+ */
+
+#include "HashTable.h"
+#include "SwissHashTable.h"
+#include "RobinHoodHashTable.h"
+#include "CompactHashTable.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+// Lookup results are accumulated here so the optimizer cannot drop them.
+volatile long long benchSink = 0;
+
+// Gives std::unordered_map the same interface as the project's tables.
+class UnorderedMapAdapter {
+public:
+    explicit UnorderedMapAdapter(size_t initCapacity) { map.reserve(initCapacity / 2); }
+    bool insert(string key, int value) { return map.emplace(std::move(key), value).second; }
+    bool remove(const string& key) { return map.erase(key) != 0; }
+    optional<int> get(const string& key) const {
+        auto it = map.find(key);
+        return it == map.end() ? nullopt : optional<int>(it->second);
+    }
+
+private:
+    unordered_map<string, int> map;
+};
+
+struct Options {
+    size_t keys = 1000000;
+    size_t ops = 2000000;
+    string dist = "uniform";
+    double zipfExponent = 0.99;
+    string engine = "all";
+    string workload = "all";
+};
+
+// Draws key indices in [0, n) with probability proportional to 1 / (rank + 1)^s.
+class ZipfGenerator {
+public:
+    ZipfGenerator(size_t n, double s) : cdf(n) {
+        double sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            sum += 1.0 / pow(static_cast<double>(i + 1), s);
+            cdf[i] = sum;
+        }
+        for (double& c : cdf) {
+            c /= sum;
+        }
+    }
+    size_t operator()(mt19937_64& rng) {
+        double u = uniform_real_distribution<double>(0.0, 1.0)(rng);
+        return min<size_t>(lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin(), cdf.size() - 1);
+    }
+
+private:
+    vector<double> cdf;
+};
+
+// URL-like keys, long enough that hashing and comparison costs are realistic.
+string makeKey(size_t i) {
+    return "https://example.com/catalog/item/" + to_string(i * 2654435761ULL % 1000000007ULL) + "?ref=" + to_string(i);
+}
+
+// Current peak resident set size in megabytes.
+double peakRssMb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0); // ru_maxrss is in bytes on macOS.
+#else
+    return usage.ru_maxrss / 1024.0; // ru_maxrss is in kilobytes on Linux.
+#endif
+#endif
+}
+
+// Collects per-operation latencies and prints one result row.
+class Recorder {
+public:
+    explicit Recorder(size_t expected) { samples.reserve(expected); }
+
+    template <typename Fn>
+    void time(Fn&& fn) {
+        auto start = chrono::steady_clock::now();
+        fn();
+        auto end = chrono::steady_clock::now();
+        samples.push_back(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+    }
+
+    void report(const string& workload, const string& engine, double seconds) {
+        sort(samples.begin(), samples.end());
+        auto pct = [&](double p) {
+            return samples.empty() ? 0 : samples[min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+        };
+        cout << left << setw(10) << workload << setw(15) << engine << right
+             << setw(14) << fixed << setprecision(0) << samples.size() / seconds
+             << setw(9) << pct(0.50) << setw(9) << pct(0.99) << setw(10) << pct(0.999)
+             << setw(11) << setprecision(1) << peakRssMb() << endl;
+    }
+
+private:
+    vector<int64_t> samples;
+};
+
+template <typename Table>
+void runWorkloads(const string& engine, const Options& opt, const vector<string>& keys,
+                  const vector<string>& missing) {
+    mt19937_64 rng(42);
+    ZipfGenerator zipf(opt.dist == "zipf" ? keys.size() : 1, opt.zipfExponent);
+    auto pick = [&]() {
+        return opt.dist == "zipf" ? zipf(rng) : static_cast<size_t>(rng() % keys.size());
+    };
+    auto wanted = [&](const string& name) { return opt.workload == "all" || opt.workload == name; };
+    auto seconds = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+
+    for (const string name : {"grow", "presized"}) {
+        if (!wanted(name)) {
+            continue;
+        }
+        Table table(name == "grow" ? HashTable::DEFAULT_INITIAL_CAPACITY : keys.size() * 2);
+        Recorder rec(keys.size());
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < keys.size(); i++) {
+            rec.time([&] { table.insert(keys[i], static_cast<int>(i)); });
+        }
+        rec.report(name, engine, seconds(start));
+    }
+
+    if (!wanted("hit") && !wanted("miss") && !wanted("churn")) {
+        return;
+    }
+
+    Table table(HashTable::DEFAULT_INITIAL_CAPACITY);
+    for (size_t i = 0; i < keys.size(); i++) {
+        table.insert(keys[i], static_cast<int>(i));
+    }
+    long long checksum = 0;
+
+    if (wanted("hit")) {
+        Recorder rec(opt.ops);
+        auto start = chrono::steady_clock::now();
+        for (size_t op = 0; op < opt.ops; op++) {
+            const string& key = keys[pick()];
+            rec.time([&] { checksum += table.get(key).value_or(0); });
+        }
+        rec.report("hit", engine, seconds(start));
+    }
+
+    if (wanted("miss")) {
+        Recorder rec(opt.ops);
+        auto start = chrono::steady_clock::now();
+        for (size_t op = 0; op < opt.ops; op++) {
+            const string& key = missing[op % missing.size()];
+            rec.time([&] { checksum += table.get(key).value_or(0); });
+        }
+        rec.report("miss", engine, seconds(start));
+    }
+
+    if (wanted("churn")) {
+        // Live keys occupy a sliding window of indices; each op retires the oldest one.
+        vector<string> extra;
+        extra.reserve(opt.ops);
+        for (size_t i = 0; i < opt.ops; i++) {
+            extra.push_back(makeKey(keys.size() + missing.size() + i));
+        }
+        Recorder rec(opt.ops);
+        auto start = chrono::steady_clock::now();
+        for (size_t op = 0; op < opt.ops; op++) {
+            const string& oldKey = op < keys.size() ? keys[op] : extra[op - keys.size()];
+            rec.time([&] {
+                table.remove(oldKey);
+                table.insert(extra[op], static_cast<int>(op));
+            });
+        }
+        rec.report("churn", engine, seconds(start));
+    }
+
+    benchSink = checksum;
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        string value = argv[i + 1];
+        if (flag == "--keys") opt.keys = stoull(value);
+        else if (flag == "--ops") opt.ops = stoull(value);
+        else if (flag == "--dist") opt.dist = value;
+        else if (flag == "--zipf") opt.zipfExponent = stod(value);
+        else if (flag == "--engine") opt.engine = value;
+        else if (flag == "--workload") opt.workload = value;
+        else {
+            cerr << "Unknown option " << flag << endl;
+            return 1;
+        }
+    }
+
+    vector<string> keys;
+    vector<string> missing;
+    keys.reserve(opt.keys);
+    for (size_t i = 0; i < opt.keys; i++) {
+        keys.push_back(makeKey(i));
+    }
+    for (size_t i = 0; i < min<size_t>(opt.keys, 1 << 20); i++) {
+        missing.push_back(makeKey(opt.keys + i));
+    }
+
+    cout << "keys=" << opt.keys << " ops=" << opt.ops << " dist=" << opt.dist;
+    if (opt.dist == "zipf") {
+        cout << " s=" << opt.zipfExponent;
+    }
+    cout << endl;
+    cout << left << setw(10) << "workload" << setw(15) << "engine" << right
+         << setw(14) << "ops/sec" << setw(9) << "p50 ns" << setw(9) << "p99 ns" << setw(10) << "p999 ns"
+         << setw(11) << "peak MB" << endl;
+
+    auto enabled = [&](const string& name) { return opt.engine == "all" || opt.engine == name; };
+    if (enabled("hashtable")) {
+        runWorkloads<HashTable>("hashtable", opt, keys, missing);
+    }
+    if (enabled("swiss")) {
+        runWorkloads<SwissHashTable>("swiss", opt, keys, missing);
+    }
+    if (enabled("robinhood")) {
+        runWorkloads<RobinHoodHashTable>("robinhood", opt, keys, missing);
+    }
+    if (enabled("compact")) {
+        runWorkloads<CompactHashTable<string, int>>("compact", opt, keys, missing);
+    }
+    if (enabled("unordered_map")) {
+        runWorkloads<UnorderedMapAdapter>("unordered_map", opt, keys, missing);
+    }
+    return 0;
+}
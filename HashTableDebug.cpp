@@ -7,8 +7,16 @@
  */
 
 #include "HashTable.h"
+#include "SwissHashTable.h"
+#include "RobinHoodHashTable.h"
+#include "CompactHashTable.h"
+#include "ConcurrentHashTable.h"
+#include "ShardedHashTable.h"
+#include "MappedHashTable.h"
 #include <iostream>
 #include <cstdlib>
+#include <thread>
+#include <filesystem>
 
 using namespace std;
 
@@ -61,13 +69,152 @@ int main() {
     cout << "Size: " << ht.size() << ", Cap: " << ht.capacity() << ", Alpha: " << ht.alpha() << endl;
     cout << ht << endl;
 
-    HashTableBucket b1("test", 1);
+    HashTableBucket b1("test", 1, DefaultHash<string>()("test"));
     cout << "B1 (Normal): " << b1 << " (Empty: " << (b1.isEmpty() ? "T" : "F") << ")" << endl;
     HashTableBucket b2;
     cout << "B2 (ESS): " << b2 << " (Empty: " << (b2.isEmpty() ? "T" : "F") << ")" << endl;
-    b2.load("loaded", 2);
+    b2.load("loaded", 2, DefaultHash<string>()("loaded"));
     cout << "B2 (Loaded): " << b2 << " (Empty: " << (b2.isEmpty() ? "T" : "F") << ")" << endl;
 
+    string_view lemonView = "lemon";
+    cout << "Get lemon by string_view: " << ht.get(lemonView).value_or(0) << endl;
+    cout << "Emplace quince: " << (ht.emplace(string_view("quince"), 150) ? "S" : "F") << endl;
+
+    ht.remove("lemon");
+    ht.remove("mango");
+    cout << "Tombstones after 2 removes: " << ht.tombstones() << endl;
+    ht.compact();
+    cout << "Tombstones after compact: " << ht.tombstones() << ", Size: " << ht.size() << ", Cap: " << ht.capacity() << endl;
+    cout << "Stats: " << ht.stats().toJson() << endl;
+
+    int valueTotal = 0;
+    for (auto [key, value] : ht) {
+        valueTotal += value;
+    }
+    ht.forEach([](const string&, int& value) { value += 1; });
+    size_t erased = ht.eraseIf([](const string& key, int) { return key.size() > 6; });
+    cout << "Value total: " << valueTotal << ", erased long keys: " << erased << ", size: " << ht.size() << endl;
+
+    ht["kiwi"] += 5;
+    auto [quinceEntry, quinceInserted] = ht.tryEmplace(string("quince"), 999);
+    auto [figEntry, figInserted] = ht.insertOrAssign(string("fig"), 77);
+    cout << "kiwi: " << ht["kiwi"] << ", quince: " << quinceEntry->second << " (" << (quinceInserted ? "new" : "kept") << ")"
+         << ", fig: " << figEntry->second << " (" << (figInserted ? "new" : "assigned") << ")"
+         << ", find apple: " << (ht.find("apple") != ht.end() ? "T" : "F") << endl;
+
+    string snapshotPath = (filesystem::temp_directory_path() / "hashtable_debug.snap").string();
+    HashTable restored;
+    bool saved = ht.save(snapshotPath);
+    bool loaded = restored.load(snapshotPath);
+    cout << "Snapshot save: " << (saved ? "S" : "F") << ", load: " << (loaded ? "S" : "F")
+         << ", size: " << restored.size() << ", papaya: " << restored.get("papaya").value_or(-1) << endl;
+
+    string mappedPath = (filesystem::temp_directory_path() / "hashtable_debug.map").string();
+    MappedHashTable::write(mappedPath, ht);
+    {
+        MappedHashTable mapped(mappedPath);
+        cout << "Mapped open: " << (mapped.isOpen() ? "S" : "F") << ", size: " << mapped.size()
+             << ", papaya: " << mapped.get("papaya").value_or(-1) << ", lemon: " << (mapped.contains("lemon") ? "T" : "F") << endl;
+    }
+    filesystem::remove(mappedPath);
+    filesystem::remove(snapshotPath);
+
+    // A seeded table's snapshot carries its seed, so another table can load it.
+    BasicHashTable<string, int, SeededHash<string>> seeded;
+    BasicHashTable<string, int, SeededHash<string>> seededCopy;
+    BasicHashTable<string, int, FastHash<string>> fast;
+    for (int i = 0; i < 100; i++) {
+        seeded.insert("seeded" + to_string(i), i);
+        fast.insert("fast" + to_string(i), i);
+    }
+    bool seededSaved = seeded.save(snapshotPath);
+    bool seededLoaded = seededCopy.load(snapshotPath);
+    cout << "Seeded snapshot save: " << (seededSaved ? "S" : "F") << ", load: " << (seededLoaded ? "S" : "F")
+         << ", seeded42: " << seededCopy.get("seeded42").value_or(-1) << ", fast42: " << fast.get("fast42").value_or(-1) << endl;
+    filesystem::remove(snapshotPath);
+
+    HashTable bulk;
+    bulk.reserve(1000);
+    size_t reservedCapacity = bulk.capacity();
+    for (int i = 0; i < 1000; i++) {
+        bulk.insert("bulk" + to_string(i), i);
+    }
+    for (int i = 0; i < 990; i++) {
+        bulk.remove("bulk" + to_string(i));
+    }
+    bulk.shrinkToFit();
+    cout << "Reserved cap: " << reservedCapacity << ", after purge and shrinkToFit: " << bulk.capacity()
+         << " (size " << bulk.size() << ")" << endl;
+
+    vector<pair<string, int>> bulkEntries;
+    for (int i = 0; i < 5000; i++) {
+        bulkEntries.push_back({"built" + to_string(i % 4000), i});
+    }
+    HashTable built = HashTable::build(bulkEntries, 4);
+    built.setRehashThreads(4);
+    built.reserve(20000);
+    cout << "Built size: " << built.size() << ", Cap: " << built.capacity()
+         << ", built3999: " << built.get("built3999").value_or(-1) << endl;
+
+    BasicHashTable<uint64_t, uint64_t> ids;
+    ids.insert(1ULL << 40, 5000000000ULL);
+    ids.insert(7, 8);
+    cout << "ids[2^40]: " << ids.get(1ULL << 40).value_or(0) << ", ids has 8: " << (ids.contains(8) ? "T" : "F") << endl;
+
+    SwissHashTable swiss;
+    for (int i = 0; i < 40; i++) {
+        swiss.insert("swiss" + to_string(i), i);
+    }
+    cout << "Swiss size: " << swiss.size() << ", Cap: " << swiss.capacity() << ", Alpha: " << swiss.alpha() << endl;
+    cout << "Swiss get swiss7: " << swiss.get("swiss7").value_or(-1) << endl;
+    cout << "Swiss remove swiss7: " << (swiss.remove("swiss7") ? "S" : "F") << endl;
+    cout << "Swiss contains swiss7: " << (swiss.contains("swiss7") ? "T" : "F") << endl;
+    cout << "Swiss insert swiss8 (duplicate): " << (swiss.insert("swiss8", 0) ? "S" : "F") << endl;
+
+    RobinHoodHashTable robin;
+    for (int i = 0; i < 50; i++) {
+        robin.insert("robin" + to_string(i), i);
+    }
+    cout << "Robin size: " << robin.size() << ", Cap: " << robin.capacity() << ", Alpha: " << robin.alpha() << endl;
+    cout << "Robin remove robin7: " << (robin.remove("robin7") ? "S" : "F") << endl;
+    cout << "Robin get robin7: " << robin.get("robin7").value_or(-1) << ", robin8: " << robin.get("robin8").value_or(-1) << endl;
+
+    CompactHashTable<string, int> compact;
+    for (int i = 0; i < 200; i++) {
+        compact.insert("compact" + to_string(i), i);
+    }
+    for (int i = 0; i < 200; i += 2) {
+        compact.remove("compact" + to_string(i));
+    }
+    compact["compact0"] = 1000;
+    compact.insert("a key stored in the arena", 7);
+    vector<string> compactKeys = compact.keys();
+    cout << "Compact size: " << compact.size() << ", Cap: " << compact.capacity() << ", Index width: "
+         << compact.indexWidth() << ", first: " << compactKeys.front() << ", arena key: " << compact.get("a key stored in the arena").value_or(-1) << endl;
+
+    ConcurrentHashTable<string, int> shared;
+    vector<thread> workers;
+    for (int t = 0; t < 4; t++) {
+        workers.emplace_back([&shared, t]() {
+            for (int i = 0; i < 1000; i++) {
+                shared.insert("t" + to_string(t) + "_" + to_string(i), i);
+                shared.get("t0_" + to_string(i));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    cout << "Concurrent size: " << shared.size() << ", t3_999: " << shared["t3_999"] << endl;
+
+    ShardedHashTable<string, int> sharded(4);
+    for (int i = 0; i < 100; i++) {
+        sharded.insert("s" + to_string(i), i);
+    }
+    sharded.remove("s50");
+    cout << "Sharded size: " << sharded.size() << ", Cap: " << sharded.capacity() << ", Shards: " << sharded.shardCount()
+         << ", s42: " << sharded.get("s42").value_or(-1) << ", s50: " << (sharded.contains("s50") ? "T" : "F") << endl;
+
     cout << "\nTESTS COMPLETE" << endl;
 
     return 0;
@@ -0,0 +1,228 @@
+/**
+ * MappedHashTable.cpp
+ * Implementation of the memory-mapped read-only table and its file writer.
+ */
+
+#include "MappedHashTable.h"
+
+#include <bit>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Move constructor. Takes over the other table's mapping.
+MappedHashTable::MappedHashTable(MappedHashTable&& other) noexcept {
+    *this = std::move(other);
+}
+
+// Move assignment. Releases this table's mapping and takes over the other's.
+MappedHashTable& MappedHashTable::operator=(MappedHashTable&& other) noexcept {
+    if (this != &other) {
+        close();
+        mapping = exchange(other.mapping, nullptr);
+        mappingSize = exchange(other.mappingSize, 0);
+        header = exchange(other.header, nullptr);
+        slots = exchange(other.slots, nullptr);
+        strings = exchange(other.strings, nullptr);
+    }
+    return *this;
+}
+
+// Lays every entry of table out in slots at most half full, in one pass over its
+// buckets, then writes the header, the slots and the string region. The file is written
+// under a temporary name in the same directory and renamed over path, so processes that
+// have the old file mapped keep reading it intact instead of faulting on a truncated file.
+bool MappedHashTable::write(const string& path, const HashTable& table) {
+    size_t capacity = bit_ceil(max<size_t>(table.size() * 2, 8));
+
+    vector<Slot> fileSlots(capacity, Slot{0, EMPTY_SLOT, 0, 0});
+    string stringRegion;
+    for (auto [key, value] : table) {
+        uint64_t hash_val = stableHash(key);
+        size_t idx = hash_val & (capacity - 1);
+        while (fileSlots[idx].keyOffset != EMPTY_SLOT) {
+            idx = (idx + 1) & (capacity - 1);
+        }
+        fileSlots[idx] = Slot{hash_val, stringRegion.size(), static_cast<uint32_t>(key.size()), value};
+        stringRegion += key;
+    }
+
+    Header fileHeader{};
+    memcpy(fileHeader.magic, MAGIC, sizeof(fileHeader.magic));
+    fileHeader.version = VERSION;
+    fileHeader.size = table.size();
+    fileHeader.capacity = capacity;
+    fileHeader.stringsSize = stringRegion.size();
+
+    string tempPath = path + ".tmp" + to_string(random_device()());
+    bool written;
+    {
+        ofstream out(tempPath, ios::binary | ios::trunc);
+        out.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+        out.write(reinterpret_cast<const char*>(fileSlots.data()), fileSlots.size() * sizeof(Slot));
+        out.write(stringRegion.data(), stringRegion.size());
+        out.close();
+        written = static_cast<bool>(out);
+    }
+
+    error_code error;
+    if (written) {
+        filesystem::rename(tempPath, path, error);
+    }
+    if (!written || error) {
+        filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+// Maps the file read-only and checks that its sections fit the file.
+bool MappedHashTable::open(const string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE fileMapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file);
+    if (fileMapping == nullptr) {
+        return false;
+    }
+    void* view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(fileMapping); // The view keeps the mapping alive.
+    if (view == nullptr) {
+        return false;
+    }
+    mapping = static_cast<const char*>(view);
+    mappingSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        view = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd); // The mapping stays valid after the descriptor is closed.
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    mapping = static_cast<const char*>(view);
+    mappingSize = static_cast<size_t>(info.st_size);
+#endif
+
+    header = reinterpret_cast<const Header*>(mapping);
+    bool valid = mappingSize >= sizeof(Header) &&
+                 memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 && header->version == VERSION &&
+                 has_single_bit(header->capacity) && header->size < header->capacity &&
+                 header->capacity <= (mappingSize - sizeof(Header)) / sizeof(Slot) &&
+                 header->stringsSize == mappingSize - sizeof(Header) - header->capacity * sizeof(Slot);
+    if (!valid) {
+        close();
+        return false;
+    }
+    slots = reinterpret_cast<const Slot*>(mapping + sizeof(Header));
+    strings = reinterpret_cast<const char*>(slots + header->capacity);
+    return true;
+}
+
+// Unmaps the file, if one is open.
+void MappedHashTable::close() {
+    if (mapping != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping);
+#else
+        munmap(const_cast<char*>(mapping), mappingSize);
+#endif
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+    header = nullptr;
+    slots = nullptr;
+    strings = nullptr;
+}
+
+// Returns true while a file is mapped.
+bool MappedHashTable::isOpen() const {
+    return mapping != nullptr;
+}
+
+// Checks if a key exists in the table.
+bool MappedHashTable::contains(string_view key) const {
+    return find(key) != nullptr;
+}
+
+// Retrieves the value associated with a key. Returns an optional<int> (nullopt if key not found).
+optional<int> MappedHashTable::get(string_view key) const {
+    if (const Slot* slot = find(key)) {
+        return slot->value;
+    }
+    return nullopt;
+}
+
+// Calculates and returns the current load factor (alpha = size / capacity).
+double MappedHashTable::alpha() const {
+    return isOpen() ? static_cast<double>(header->size) / static_cast<double>(header->capacity) : 0.0;
+}
+
+// Returns the total number of slots in the file (capacity).
+size_t MappedHashTable::capacity() const {
+    return isOpen() ? header->capacity : 0;
+}
+
+// Returns the number of keys in the file (size).
+size_t MappedHashTable::size() const {
+    return isOpen() ? header->size : 0;
+}
+
+// 64-bit FNV-1a over the key's bytes.
+uint64_t MappedHashTable::stableHash(string_view key) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : key) {
+        h = (h ^ c) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Probes linearly from the home slot until the key or an empty slot. Key offsets are
+// bounds-checked here rather than at open(), so opening never reads the whole file.
+auto MappedHashTable::find(string_view key) const -> const Slot* {
+    if (!isOpen()) {
+        return nullptr;
+    }
+    uint64_t hash_val = stableHash(key);
+    size_t mask = header->capacity - 1;
+
+    for (size_t idx = hash_val & mask, step = 0; step < header->capacity; idx = (idx + 1) & mask, step++) {
+        const Slot& slot = slots[idx];
+        if (slot.keyOffset == EMPTY_SLOT) {
+            return nullptr;
+        }
+        if (slot.hash == hash_val && slot.keyLength == key.size() &&
+            slot.keyOffset <= header->stringsSize && slot.keyLength <= header->stringsSize - slot.keyOffset &&
+            string_view(strings + slot.keyOffset, slot.keyLength) == key) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,92 @@
+/**
+ * MappedHashTable.h
+ * Defines the MappedHashTable class, a read-only string-to-int table served straight
+ * from a memory-mapped file.
+ *
+ * write() turns a HashTable into a file; open() maps it and lookups read the mapping
+ * in place, so opening costs no parsing or copying and processes that map the same
+ * file share its pages. The file holds a header, a power-of-two array of fixed-size
+ * slots probed linearly, and one region with every key's characters. Slots refer to
+ * their key by offset into that region. Keys are hashed with 64-bit FNV-1a, which
+ * unlike std::hash is the same in every build, so files can be shared between builds.
+ */
+
+#ifndef MAPPEDHASHTABLE_H
+#define MAPPEDHASHTABLE_H
+
+#include "HashTable.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+class MappedHashTable {
+public:
+
+    MappedHashTable() = default;
+    // Opens path; check isOpen() for the result.
+    explicit MappedHashTable(const string& path) { open(path); }
+    ~MappedHashTable() { close(); }
+
+    MappedHashTable(const MappedHashTable&) = delete;
+    MappedHashTable& operator=(const MappedHashTable&) = delete;
+    MappedHashTable(MappedHashTable&& other) noexcept;
+    MappedHashTable& operator=(MappedHashTable&& other) noexcept;
+
+    // Writes the contents of table to path in the mapped format, replacing any existing
+    // file atomically. Returns false on I/O errors.
+    static bool write(const string& path, const HashTable& table);
+
+    // Maps a file written by write(), closing any file already open. Returns false if the
+    // file cannot be mapped or is not a valid table.
+    bool open(const string& path);
+    // Unmaps the file. Lookups on a closed table find nothing.
+    void close();
+    bool isOpen() const;
+
+    // Accessors. Lookups never allocate or copy.
+    bool contains(string_view key) const;
+    optional<int> get(string_view key) const;
+
+    // Status Metrics
+    double alpha() const;     // Calculates and returns the load factor (size/capacity).
+    size_t capacity() const;  // Returns the total slot count.
+    size_t size() const;      // Returns the number of stored elements.
+
+    // 64-bit FNV-1a, the hash stored in the file.
+    static uint64_t stableHash(string_view key);
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t size;         // Number of keys.
+        uint64_t capacity;     // Number of slots (power of two).
+        uint64_t stringsSize;  // Bytes in the string region, which follows the slots.
+    };
+    struct Slot {
+        uint64_t hash;
+        uint64_t keyOffset;    // Offset into the string region, or EMPTY_SLOT.
+        uint32_t keyLength;
+        int32_t value;
+    };
+    static constexpr char MAGIC[8] = {'H', 'T', 'M', 'A', 'P', '\0', '\0', '\0'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint64_t EMPTY_SLOT = UINT64_MAX;
+
+    const char* mapping = nullptr;  // Start of the mapped file.
+    size_t mappingSize = 0;
+    const Header* header = nullptr;
+    const Slot* slots = nullptr;
+    const char* strings = nullptr;
+
+    // Returns the slot holding key, or nullptr if it is absent.
+    const Slot* find(string_view key) const;
+
+};
+
+#endif
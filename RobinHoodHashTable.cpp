@@ -0,0 +1,181 @@
+/**
+ * RobinHoodHashTable.cpp
+ * Implementation of the Robin Hood hash table engine: linear probing with
+ * displacement by probe distance and backward-shift deletion.
+ */
+
+#include "RobinHoodHashTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+// Constructor. Rounds the capacity up to a power of two so probing can mask instead of divide.
+RobinHoodHashTable::RobinHoodHashTable(size_t initCapacity) {
+    currentCapacity = bit_ceil(max<size_t>(initCapacity, 2));
+    slots.resize(currentCapacity);
+}
+
+// Inserts a key-value pair into the table. Returns true on success, false on duplicate key.
+bool RobinHoodHashTable::insert(string key, size_t value) {
+    size_t hash_val = hash<string_view>()(key);
+    if (find(key, hash_val)) {
+        return false; // Duplicate found, insertion failed.
+    }
+    insertNew(std::move(key), static_cast<int>(value), hash_val);
+    return true;
+}
+
+// Removes a key-value pair from the table. Returns true on success, false if key not found.
+bool RobinHoodHashTable::remove(string_view key) {
+    optional<size_t> idx = find(key, hash<string_view>()(key));
+    if (!idx) {
+        return false;
+    }
+
+    // Shift the rest of the run back one slot until an empty slot or an entry already
+    // at its home slot. Every shifted entry moves one step closer to home.
+    size_t mask = currentCapacity - 1;
+    size_t hole = *idx;
+    for (size_t next = (hole + 1) & mask; slots[next].distance > 1; next = (next + 1) & mask) {
+        slots[hole] = std::move(slots[next]);
+        slots[hole].distance--;
+        hole = next;
+    }
+    slots[hole].key = string(); // Release the key's storage.
+    slots[hole].distance = 0;
+    currentSize--;
+    return true;
+}
+
+// Checks if a key exists in the hash table.
+bool RobinHoodHashTable::contains(string_view key) const {
+    return find(key, hash<string_view>()(key)).has_value();
+}
+
+// Retrieves the value associated with a key. Returns an optional<int> (nullopt if key not found).
+optional<int> RobinHoodHashTable::get(string_view key) const {
+    if (optional<size_t> idx = find(key, hash<string_view>()(key))) {
+        return slots[*idx].value;
+    }
+    return nullopt;
+}
+
+// Returns a reference to the value for key, inserting key with value 0 first if it is absent.
+int& RobinHoodHashTable::operator[](string_view key) {
+    size_t hash_val = hash<string_view>()(key);
+    if (optional<size_t> idx = find(key, hash_val)) {
+        return slots[*idx].value;
+    }
+    return slots[insertNew(string(key), 0, hash_val)].value;
+}
+
+// Returns a vector containing all keys currently stored in the table.
+vector<string> RobinHoodHashTable::keys() const {
+    vector<string> allKeys;
+    allKeys.reserve(currentSize);
+    for (const Slot& slot : slots) {
+        if (slot.distance != 0) {
+            allKeys.push_back(slot.key);
+        }
+    }
+    return allKeys;
+}
+
+// Calculates and returns the current load factor (alpha = size / capacity).
+double RobinHoodHashTable::alpha() const {
+    return static_cast<double>(currentSize) / static_cast<double>(currentCapacity);
+}
+
+// Returns the total number of slots available in the table (capacity).
+size_t RobinHoodHashTable::capacity() const {
+    return currentCapacity;
+}
+
+// Returns the number of elements currently stored in the table (size).
+size_t RobinHoodHashTable::size() const {
+    return currentSize;
+}
+
+// Overloads the stream insertion operator for the entire hash table.
+ostream& operator<<(ostream& os, const RobinHoodHashTable& hashTable) {
+    for (size_t i = 0; i < hashTable.currentCapacity; ++i) {
+        const auto& slot = hashTable.slots[i];
+        if (slot.distance != 0) {
+            os << "Bucket " << i << ": <" << slot.key << ", " << slot.value << ">" << endl;
+        }
+    }
+    return os;
+}
+
+// Probes linearly from the home slot. A miss ends at an empty slot, or at a slot whose
+// entry is closer to its home than the key would be: the key would have taken that slot.
+optional<size_t> RobinHoodHashTable::find(string_view key, size_t hash) const {
+    size_t mask = currentCapacity - 1;
+    size_t idx = hash & mask;
+
+    for (uint32_t distance = 1; ; distance++) {
+        const Slot& slot = slots[idx];
+        if (slot.distance < distance) {
+            return nullopt; // Empty (0) or a richer entry.
+        }
+        if (slot.hash == hash && slot.key == key) {
+            return idx;
+        }
+        idx = (idx + 1) & mask;
+    }
+}
+
+// Stores a key known to be absent, growing first if the table is at its load limit.
+size_t RobinHoodHashTable::insertNew(string key, int value, size_t hash) {
+    if (currentSize + 1 > maxLoad(currentCapacity)) {
+        rehash(currentCapacity * 2);
+    }
+
+    Slot entry;
+    entry.key = std::move(key);
+    entry.value = value;
+    entry.hash = hash;
+    currentSize++;
+    return place(std::move(entry));
+}
+
+// Walks from the entry's home slot, swapping it with any resident that is closer to
+// its own home, until the carried entry lands in an empty slot. Returns the slot the
+// original entry ended up in: the first one it displaced a resident from, if any.
+size_t RobinHoodHashTable::place(Slot entry) {
+    size_t mask = currentCapacity - 1;
+    size_t idx = entry.hash & mask;
+    entry.distance = 1;
+    optional<size_t> placedAt;
+
+    while (slots[idx].distance != 0) {
+        if (slots[idx].distance < entry.distance) {
+            swap(entry, slots[idx]);
+            placedAt = placedAt.value_or(idx);
+        }
+        entry.distance++;
+        idx = (idx + 1) & mask;
+    }
+    slots[idx] = std::move(entry);
+    return placedAt.value_or(idx);
+}
+
+// Rebuilds the slot array at newCapacity and moves every element across.
+void RobinHoodHashTable::rehash(size_t newCapacity) {
+    vector<Slot> newSlots(newCapacity); // Allocate before touching the table.
+    vector<Slot> oldSlots = std::move(slots);
+    slots = std::move(newSlots);
+    currentCapacity = newCapacity;
+
+    for (Slot& slot : oldSlots) {
+        if (slot.distance != 0) {
+            place(std::move(slot));
+        }
+    }
+}
+
+// Robin Hood probe lengths stay short up to high load, so the table fills to 7/8.
+size_t RobinHoodHashTable::maxLoad(size_t capacity) {
+    return capacity - max<size_t>(capacity / 8, 1); // Keep an empty slot so probes terminate.
+}
@@ -0,0 +1,82 @@
+/**
+ * RobinHoodHashTable.h
+ * Defines the RobinHoodHashTable class, an alternative storage engine with the same
+ * public interface as HashTable.
+ *
+ * Slots are probed linearly. Each occupied slot records how far it sits from its home
+ * slot (its probe distance); an insert that has travelled further than the resident of
+ * a slot takes that slot and carries the resident on. This keeps probe distances close
+ * to the mean, lets a lookup stop as soon as it has gone further than the slot it is
+ * looking at, and makes deletes shift the following run back instead of leaving
+ * tombstones. The table runs up to 7/8 full.
+ */
+
+#ifndef ROBINHOODHASHTABLE_H
+#define ROBINHOODHASHTABLE_H
+
+#include <iostream>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+
+using namespace std;
+
+class RobinHoodHashTable {
+public:
+
+    // Default capacity for initialization.
+    static constexpr size_t DEFAULT_INITIAL_CAPACITY = 8;
+
+    // Constructor; capacity is rounded up to a power of two.
+    RobinHoodHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY);
+
+    // Core Mutators and Accessors
+    bool insert(string key, size_t value);
+    // Lookups take a string_view, so string, string_view and const char* keys never allocate.
+    bool remove(string_view key);
+    bool contains(string_view key) const;
+    // Retrieves value. Returns optional<int> to handle key absence.
+    optional<int> get(string_view key) const;
+    // Subscript operator. Returns reference to value, inserting key with value 0 if it is absent.
+    int& operator[](string_view key);
+    // Returns a vector containing all keys in the table.
+    vector<string> keys() const;
+
+    // Status Metrics
+    double alpha() const;     // Calculates and returns the load factor (size/capacity).
+    size_t capacity() const;  // Returns the total slot count.
+    size_t size() const;      // Returns the number of stored elements.
+
+    // Stream output operator for displaying the entire table.
+    friend ostream& operator<<(ostream& os, const RobinHoodHashTable& hashTable);
+
+private:
+    // One slot. distance is the probe distance plus one, so 0 marks an empty slot.
+    struct Slot {
+        string key;
+        int value = 0;
+        uint32_t distance = 0;
+        size_t hash = 0;   // Cached so rehashing never rehashes keys.
+    };
+
+    vector<Slot> slots;
+    size_t currentSize = 0;      // Current element count.
+    size_t currentCapacity = 0;  // Number of slots (power of two).
+
+    // Returns the index of the slot holding key, or nullopt if it is absent.
+    optional<size_t> find(string_view key, size_t hash) const;
+    // Stores a key that is known to be absent and returns its slot index.
+    size_t insertNew(string key, int value, size_t hash);
+    // Places an entry known to be absent, displacing entries closer to their home slots.
+    // Returns the entry's slot index.
+    size_t place(Slot entry);
+    // Rebuilds the table at newCapacity.
+    void rehash(size_t newCapacity);
+    // Number of slots that may be occupied at a capacity.
+    static size_t maxLoad(size_t capacity);
+
+};
+
+#endif
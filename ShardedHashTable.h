@@ -0,0 +1,214 @@
+/**
+ * ShardedHashTable.h
+ * Defines the ShardedHashTable class template: N independent BasicHashTable shards,
+ * each behind its own reader/writer lock.
+ *
+ * Keys are routed to a shard by the high bits of their hash, while each shard picks
+ * home buckets from a multiplicative mix of the whole hash, so keys sharing a shard
+ * still spread across its buckets. Every shard keeps its own
+ * load factor and resizes on its own, which bounds a rehash pause to one shard's data
+ * and lets writers on different shards run in parallel. Shards never reseed a
+ * SeededHash policy on their own, since every hash they store comes from this table.
+ */
+
+#ifndef SHARDEDHASHTABLE_H
+#define SHARDEDHASHTABLE_H
+
+#include "HashTable.h"
+
+#include <bit>
+#include <mutex>
+#include <shared_mutex>
+
+template <typename Key,
+          typename Value,
+          typename Hash = DefaultHash<Key>,
+          typename KeyEqual = DefaultKeyEqual<Key>,
+          typename Allocator = allocator<pair<const Key, Value>>>
+class ShardedHashTable {
+public:
+
+    using Table = BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>;
+
+    // Default number of shards.
+    static constexpr size_t DEFAULT_SHARD_COUNT = 16;
+
+    // Constructor; shardCount is rounded up to a power of two and each shard starts
+    // with shardCapacity buckets.
+    ShardedHashTable(size_t shardCount = DEFAULT_SHARD_COUNT,
+                     size_t shardCapacity = Table::DEFAULT_INITIAL_CAPACITY,
+                     const Hash& hasher = Hash(), const KeyEqual& keyEqual = KeyEqual(),
+                     const Allocator& alloc = Allocator());
+
+    // Core Mutators and Accessors. Each locks only the shard that owns the key;
+    // lookups take the lock shared, so readers of one shard do not block each other.
+    bool insert(Key key, Value value);
+    bool remove(const Key& key) { return removeKey(key); }
+    bool contains(const Key& key) const { return getValue(key).has_value(); }
+    optional<Value> get(const Key& key) const { return getValue(key); }
+    // Replaces the value of an existing key. Returns false if the key is absent.
+    bool assign(const Key& key, Value value) { return assignKey(key, std::move(value)); }
+
+    // Heterogeneous lookups, enabled when Hash and KeyEqual are transparent.
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    bool remove(const K& key) { return removeKey(key); }
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    bool contains(const K& key) const { return getValue(key).has_value(); }
+    template <typename K> requires TransparentPolicies<Hash, KeyEqual>
+    optional<Value> get(const K& key) const { return getValue(key); }
+
+    // Returns a vector containing the keys of every shard.
+    vector<Key> keys() const;
+
+    // Status Metrics, aggregated across shards. Each shard is read under its own lock,
+    // so under concurrent writes the totals are a sum of per-shard snapshots.
+    double alpha() const;     // Total size over total capacity.
+    size_t capacity() const;  // Sum of shard capacities.
+    size_t size() const;      // Sum of shard sizes.
+    size_t shardCount() const; // Number of shards.
+
+private:
+    // One shard per cache line so neighbouring locks do not false-share.
+    struct alignas(64) Shard {
+        mutable shared_mutex lock;
+        Table table;
+        Shard(size_t capacity, const Hash& hasher, const KeyEqual& keyEqual, const Allocator& alloc):
+            table(capacity, hasher, keyEqual, alloc) {
+            table.externalHashes = true; // Hashes come from the sharded table's policy.
+        }
+    };
+
+    // Picks the shard from the top bits of the hash.
+    Shard& shardFor(size_t hash) const { return *shards[shardBits == 0 ? 0 : hash >> (64 - shardBits)]; }
+
+    template <typename K> bool removeKey(const K& key);
+    template <typename K> optional<Value> getValue(const K& key) const;
+    template <typename K> bool assignKey(const K& key, Value value);
+
+    [[no_unique_address]] Hash hasher;
+    size_t shardBits = 0;              // log2 of the shard count.
+    size_t shardTotal = 0;             // Number of shards.
+    vector<unique_ptr<Shard>> shards;  // Boxed: shards hold non-movable locks.
+};
+
+#define SHARDED_TEMPLATE template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+#define SHARDED_TYPE ShardedHashTable<Key, Value, Hash, KeyEqual, Allocator>
+
+// Constructor. Builds every shard up front.
+SHARDED_TEMPLATE
+SHARDED_TYPE::ShardedHashTable(size_t shardCount, size_t shardCapacity, const Hash& hasher,
+                               const KeyEqual& keyEqual, const Allocator& alloc):
+    hasher(hasher) {
+    static_assert(sizeof(size_t) == 8, "shard routing uses the top bits of a 64-bit hash");
+    shardTotal = bit_ceil(max<size_t>(shardCount, 1));
+    shardBits = countr_zero(shardTotal);
+
+    shards.reserve(shardTotal);
+    for (size_t i = 0; i < shardTotal; i++) {
+        shards.push_back(make_unique<Shard>(shardCapacity, hasher, keyEqual, alloc));
+    }
+}
+
+// Inserts a key-value pair into its shard. Returns true on success, false on duplicate key.
+SHARDED_TEMPLATE
+bool SHARDED_TYPE::insert(Key key, Value value) {
+    size_t hash_val = hasher(key);
+    Shard& shard = shardFor(hash_val);
+    unique_lock<shared_mutex> lock(shard.lock);
+    return shard.table.emplaceHashed(hash_val, std::move(key), std::move(value));
+}
+
+// Removes a key from its shard.
+SHARDED_TEMPLATE
+template <typename K>
+bool SHARDED_TYPE::removeKey(const K& key) {
+    size_t hash_val = hasher(key);
+    Shard& shard = shardFor(hash_val);
+    unique_lock<shared_mutex> lock(shard.lock);
+    return shard.table.removeHashed(key, hash_val);
+}
+
+// Retrieves the value for a key from its shard.
+SHARDED_TEMPLATE
+template <typename K>
+optional<Value> SHARDED_TYPE::getValue(const K& key) const {
+    size_t hash_val = hasher(key);
+    const Shard& shard = shardFor(hash_val);
+    shared_lock<shared_mutex> lock(shard.lock);
+    if (const auto* bucket = shard.table.find(key, hash_val)) {
+        return bucket->value;
+    }
+    return nullopt;
+}
+
+// Overwrites the value of a key that is already present.
+SHARDED_TEMPLATE
+template <typename K>
+bool SHARDED_TYPE::assignKey(const K& key, Value value) {
+    size_t hash_val = hasher(key);
+    Shard& shard = shardFor(hash_val);
+    unique_lock<shared_mutex> lock(shard.lock);
+    if (auto* bucket = shard.table.find(key, hash_val)) {
+        bucket->value = std::move(value);
+        return true;
+    }
+    return false;
+}
+
+// Returns the keys of all shards, one shard at a time.
+SHARDED_TEMPLATE
+vector<Key> SHARDED_TYPE::keys() const {
+    vector<Key> allKeys;
+    for (size_t i = 0; i < shardTotal; i++) {
+        shared_lock<shared_mutex> lock(shards[i]->lock);
+        vector<Key> shardKeys = shards[i]->table.keys();
+        allKeys.insert(allKeys.end(), make_move_iterator(shardKeys.begin()), make_move_iterator(shardKeys.end()));
+    }
+    return allKeys;
+}
+
+// Calculates the load factor over all shards.
+SHARDED_TEMPLATE
+double SHARDED_TYPE::alpha() const {
+    size_t totalSize = 0;
+    size_t totalCapacity = 0;
+    for (size_t i = 0; i < shardTotal; i++) {
+        shared_lock<shared_mutex> lock(shards[i]->lock);
+        totalSize += shards[i]->table.size();
+        totalCapacity += shards[i]->table.capacity();
+    }
+    return static_cast<double>(totalSize) / static_cast<double>(totalCapacity);
+}
+
+// Returns the total number of buckets over all shards.
+SHARDED_TEMPLATE
+size_t SHARDED_TYPE::capacity() const {
+    size_t total = 0;
+    for (size_t i = 0; i < shardTotal; i++) {
+        shared_lock<shared_mutex> lock(shards[i]->lock);
+        total += shards[i]->table.capacity();
+    }
+    return total;
+}
+
+// Returns the number of elements stored over all shards.
+SHARDED_TEMPLATE
+size_t SHARDED_TYPE::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < shardTotal; i++) {
+        shared_lock<shared_mutex> lock(shards[i]->lock);
+        total += shards[i]->table.size();
+    }
+    return total;
+}
+
+// Returns the number of shards.
+SHARDED_TEMPLATE
+size_t SHARDED_TYPE::shardCount() const {
+    return shardTotal;
+}
+
+#undef SHARDED_TEMPLATE
+#undef SHARDED_TYPE
+
+#endif
@@ -0,0 +1,256 @@
+/**
+ * SwissHashTable.cpp
+ * Implementation of the control-byte hash table engine. Groups of 16 control
+ * bytes are compared with SSE2 when available, with a portable fallback.
+ */
+
+#include "SwissHashTable.h"
+
+#include <bit>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// A window of GROUP_WIDTH control bytes. Each match returns a bitmask with
+// bit i set when byte i satisfies the test.
+class ControlGroup {
+public:
+#ifdef __SSE2__
+    explicit ControlGroup(const int8_t* pos):
+        ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+    // Bytes equal to the given fingerprint.
+    uint32_t match(int8_t fingerprint) const {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(fingerprint)));
+    }
+    // Bytes that are EMPTY. Only EMPTY equals -128.
+    uint32_t matchEmpty() const {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(-128)));
+    }
+    // Bytes that are EMPTY or DELETED; both are the only negative values.
+    uint32_t matchEmptyOrDeleted() const {
+        return _mm_movemask_epi8(ctrl);
+    }
+
+private:
+    __m128i ctrl;
+#else
+    explicit ControlGroup(const int8_t* pos): ctrl(pos) {}
+
+    uint32_t match(int8_t fingerprint) const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < SwissHashTable::GROUP_WIDTH; i++) {
+            mask |= static_cast<uint32_t>(ctrl[i] == fingerprint) << i;
+        }
+        return mask;
+    }
+    uint32_t matchEmpty() const {
+        return match(-128);
+    }
+    uint32_t matchEmptyOrDeleted() const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < SwissHashTable::GROUP_WIDTH; i++) {
+            mask |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+        }
+        return mask;
+    }
+
+private:
+    const int8_t* ctrl;
+#endif
+};
+
+// The low 7 bits of the hash are the fingerprint stored in the control byte;
+// the remaining bits choose where probing starts.
+inline size_t homeHash(size_t hash) { return hash >> 7; }
+inline int8_t fingerprint(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+} // namespace
+
+// Constructor. Rounds the capacity up to a power of two so probing can mask instead of divide.
+SwissHashTable::SwissHashTable(size_t initCapacity) {
+    currentCapacity = bit_ceil(max(initCapacity, GROUP_WIDTH));
+    control.assign(currentCapacity + GROUP_WIDTH, CTRL_EMPTY);
+    slots.resize(currentCapacity);
+    growthLeft = maxLoad(currentCapacity);
+}
+
+// Inserts a key-value pair into the table. Returns true on success, false on duplicate key.
+bool SwissHashTable::insert(string key, size_t value) {
+    size_t hash_val = hash<string_view>()(key);
+    if (find(key, hash_val)) {
+        return false; // Duplicate found, insertion failed.
+    }
+    insertNew(std::move(key), static_cast<int>(value), hash_val);
+    return true;
+}
+
+// Removes a key-value pair from the table. Returns true on success, false if key not found.
+bool SwissHashTable::remove(string_view key) {
+    optional<size_t> idx = find(key, hash<string_view>()(key));
+    if (!idx) {
+        return false;
+    }
+    // DELETED keeps probe sequences that run through this slot intact.
+    setControl(*idx, CTRL_DELETED);
+    slots[*idx].key = string(); // Release the key's storage.
+    currentSize--;
+    return true;
+}
+
+// Checks if a key exists in the hash table.
+bool SwissHashTable::contains(string_view key) const {
+    return find(key, hash<string_view>()(key)).has_value();
+}
+
+// Retrieves the value associated with a key. Returns an optional<int> (nullopt if key not found).
+optional<int> SwissHashTable::get(string_view key) const {
+    if (optional<size_t> idx = find(key, hash<string_view>()(key))) {
+        return slots[*idx].value;
+    }
+    return nullopt;
+}
+
+// Returns a reference to the value for key, inserting key with value 0 first if it is absent.
+int& SwissHashTable::operator[](string_view key) {
+    size_t hash_val = hash<string_view>()(key);
+    if (optional<size_t> idx = find(key, hash_val)) {
+        return slots[*idx].value;
+    }
+    return slots[insertNew(string(key), 0, hash_val)].value;
+}
+
+// Returns a vector containing all keys currently stored in the table.
+vector<string> SwissHashTable::keys() const {
+    vector<string> allKeys;
+    allKeys.reserve(currentSize);
+    for (size_t i = 0; i < currentCapacity; i++) {
+        if (control[i] >= 0) {
+            allKeys.push_back(slots[i].key);
+        }
+    }
+    return allKeys;
+}
+
+// Calculates and returns the current load factor (alpha = size / capacity).
+double SwissHashTable::alpha() const {
+    return static_cast<double>(currentSize) / static_cast<double>(currentCapacity);
+}
+
+// Returns the total number of slots available in the table (capacity).
+size_t SwissHashTable::capacity() const {
+    return currentCapacity;
+}
+
+// Returns the number of elements currently stored in the table (size).
+size_t SwissHashTable::size() const {
+    return currentSize;
+}
+
+// Overloads the stream insertion operator for the entire hash table.
+ostream& operator<<(ostream& os, const SwissHashTable& hashTable) {
+    for (size_t i = 0; i < hashTable.currentCapacity; ++i) {
+        if (hashTable.control[i] >= 0) {
+            const auto& slot = hashTable.slots[i];
+            os << "Bucket " << i << ": <" << slot.key << ", " << slot.value << ">" << endl;
+        }
+    }
+    return os;
+}
+
+// Probes group by group. Only slots whose fingerprint matches have their key compared,
+// and the search stops at the first group that contains an EMPTY slot.
+optional<size_t> SwissHashTable::find(string_view key, size_t hash) const {
+    size_t mask = currentCapacity - 1;
+    size_t offset = homeHash(hash) & mask;
+    int8_t fp = fingerprint(hash);
+
+    // Triangular steps over groups visit every group once for power-of-two capacities.
+    for (size_t step = GROUP_WIDTH; ; step += GROUP_WIDTH) {
+        ControlGroup group(&control[offset]);
+        for (uint32_t matches = group.match(fp); matches != 0; matches &= matches - 1) {
+            size_t idx = (offset + countr_zero(matches)) & mask;
+            if (slots[idx].key == key) {
+                return idx;
+            }
+        }
+        if (group.matchEmpty() != 0) {
+            return nullopt;
+        }
+        offset = (offset + step) & mask;
+    }
+}
+
+// Stores a key known to be absent, growing or cleaning up first if no EMPTY slot may be used.
+size_t SwissHashTable::insertNew(string key, int value, size_t hash) {
+    if (growthLeft == 0) {
+        // Mostly tombstones: clean up in place. Otherwise grow.
+        rehash(currentSize < maxLoad(currentCapacity) / 2 ? currentCapacity : currentCapacity * 2);
+    }
+
+    size_t idx = findInsertSlot(hash);
+    if (control[idx] == CTRL_EMPTY) {
+        growthLeft--; // Reusing a tombstone does not consume an empty slot.
+    }
+    setControl(idx, fingerprint(hash));
+    slots[idx].key = std::move(key);
+    slots[idx].value = value;
+    currentSize++;
+    return idx;
+}
+
+// Follows the same probe sequence as find() and returns the first free slot.
+size_t SwissHashTable::findInsertSlot(size_t hash) const {
+    size_t mask = currentCapacity - 1;
+    size_t offset = homeHash(hash) & mask;
+
+    for (size_t step = GROUP_WIDTH; ; step += GROUP_WIDTH) {
+        uint32_t free = ControlGroup(&control[offset]).matchEmptyOrDeleted();
+        if (free != 0) {
+            return (offset + countr_zero(free)) & mask;
+        }
+        offset = (offset + step) & mask;
+    }
+}
+
+// Sets a control byte and its mirror in the tail, if it has one.
+void SwissHashTable::setControl(size_t index, int8_t value) {
+    control[index] = value;
+    if (index < GROUP_WIDTH) {
+        control[currentCapacity + index] = value;
+    }
+}
+
+// Rebuilds the control and slot arrays at newCapacity and moves every element across.
+void SwissHashTable::rehash(size_t newCapacity) {
+    // Allocate before touching the table so a failed allocation leaves it intact.
+    vector<int8_t> newControl(newCapacity + GROUP_WIDTH, CTRL_EMPTY);
+    vector<Slot> newSlots(newCapacity);
+
+    vector<int8_t> oldControl = std::move(control);
+    vector<Slot> oldSlots = std::move(slots);
+    size_t oldCapacity = currentCapacity;
+
+    control = std::move(newControl);
+    slots = std::move(newSlots);
+    currentCapacity = newCapacity;
+    growthLeft = maxLoad(newCapacity) - currentSize;
+
+    hash<string> hasher;
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (oldControl[i] >= 0) {
+            size_t hash_val = hasher(oldSlots[i].key);
+            size_t idx = findInsertSlot(hash_val);
+            setControl(idx, fingerprint(hash_val));
+            slots[idx] = std::move(oldSlots[i]);
+        }
+    }
+}
+
+// Keeps at least one EMPTY slot in seven of eight so unsuccessful probes terminate early.
+size_t SwissHashTable::maxLoad(size_t capacity) {
+    return capacity - capacity / 8;
+}
@@ -0,0 +1,89 @@
+/**
+ * SwissHashTable.h
+ * Defines the SwissHashTable class, an alternative storage engine with the same
+ * public interface as HashTable.
+ *
+ * Bucket state lives in a separate array of one control byte per slot. A full
+ * slot's control byte holds the low 7 bits of its hash (the fingerprint); empty
+ * and deleted slots use negative values. Lookups compare 16 control bytes at a
+ * time and only touch a slot's key when its fingerprint matches.
+ */
+
+#ifndef SWISSHASHTABLE_H
+#define SWISSHASHTABLE_H
+
+#include <iostream>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+
+using namespace std;
+
+class SwissHashTable {
+public:
+
+    // Default capacity for initialization (one control group).
+    static constexpr size_t DEFAULT_INITIAL_CAPACITY = 16;
+    // Number of control bytes examined per probe step.
+    static constexpr size_t GROUP_WIDTH = 16;
+
+    // Constructor; capacity is rounded up to a power of two of at least GROUP_WIDTH.
+    SwissHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY);
+
+    // Core Mutators and Accessors
+    bool insert(string key, size_t value);
+    // Lookups take a string_view, so string, string_view and const char* keys never allocate.
+    bool remove(string_view key);
+    bool contains(string_view key) const;
+    // Retrieves value. Returns optional<int> to handle key absence.
+    optional<int> get(string_view key) const;
+    // Subscript operator. Returns reference to value, inserting key with value 0 if it is absent.
+    int& operator[](string_view key);
+    // Returns a vector containing all keys in the table.
+    vector<string> keys() const;
+
+    // Status Metrics
+    double alpha() const;     // Calculates and returns the load factor (size/capacity).
+    size_t capacity() const;  // Returns the total slot count.
+    size_t size() const;      // Returns the number of stored elements.
+
+    // Stream output operator for displaying the entire table.
+    friend ostream& operator<<(ostream& os, const SwissHashTable& hashTable);
+
+private:
+    // Control byte values for slots that do not hold data. Full slots store 0..127.
+    static constexpr int8_t CTRL_EMPTY = -128;  // Never used since the last rehash.
+    static constexpr int8_t CTRL_DELETED = -2;  // Tombstone left by remove().
+
+    // Key-value storage for one slot; only read when the control byte matches.
+    struct Slot {
+        string key;
+        int value = 0;
+    };
+
+    // Control bytes: currentCapacity entries followed by a mirror of the first
+    // GROUP_WIDTH, so a group can be loaded at any slot index without wrapping.
+    vector<int8_t> control;
+    vector<Slot> slots;
+    size_t currentSize = 0;      // Current element count.
+    size_t currentCapacity = 0;  // Number of slots (power of two).
+    size_t growthLeft = 0;       // EMPTY slots that may still be filled before a rehash.
+
+    // Returns the index of the slot holding key, or nullopt if it is absent.
+    optional<size_t> find(string_view key, size_t hash) const;
+    // Stores a key that is known to be absent and returns its slot index.
+    size_t insertNew(string key, int value, size_t hash);
+    // Returns the first EMPTY or DELETED slot on the probe sequence for hash.
+    size_t findInsertSlot(size_t hash) const;
+    // Writes a control byte, keeping the mirrored tail in sync.
+    void setControl(size_t index, int8_t value);
+    // Rebuilds the table at newCapacity, dropping all tombstones.
+    void rehash(size_t newCapacity);
+    // Number of slots that may be occupied (including tombstones) at a capacity.
+    static size_t maxLoad(size_t capacity);
+
+};
+
+#endif